@@ -0,0 +1,416 @@
+/*!
+ * @file Benchmark of doubly linked list operations.
+ *
+ * Usage: bench [--perf] [elements amount]
+ *
+ * With --perf option hardware counters are read around every benchmark case
+ * using perf_event_open(2). If some counter is unavailable (unsupported
+ * hardware, virtual machine, restrictive perf_event_paranoid) it is
+ * reported as "n/a" and the benchmark continues.
+ *
+ * @note Build it with NDEBUG macro defined, otherwise every list call
+ * validates the whole list.
+ */
+
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#endif // defined __linux__
+
+#include "../src/list.h"
+
+
+
+
+/*!
+ * @brief Default amount of elements in benchmark lists.
+ */
+#define BENCH_DEFAULT_N ((size_t) 1000000)
+
+/*!
+ * @brief Indexes of hardware counters.
+ */
+typedef enum
+{
+	BENCH_CYCLES       = 0,
+	BENCH_INSTRUCTIONS = 1,
+	BENCH_L1D_MISSES   = 2,
+	BENCH_LLC_MISSES   = 3,
+	BENCH_DTLB_MISSES  = 4,
+	BENCH_BRANCH_MISS  = 5,
+	BENCH_COUNTERS_NUM = 6,
+}
+bench_counter_t;
+
+/*!
+ * @brief Names of hardware counters.
+ */
+static const char* const BENCH_COUNTER_NAMES[BENCH_COUNTERS_NUM] =
+{
+	"cycles", "instructions", "L1d-misses",
+	"LLC-misses", "dTLB-misses", "branch-misses",
+};
+
+/*!
+ * @brief Set of opened hardware counters.
+ */
+typedef struct
+{
+	int      fds[BENCH_COUNTERS_NUM];    /*!< descriptors of counters or -1
+	                                          if counter is unavailable.     */
+	unsigned long long
+	         values[BENCH_COUNTERS_NUM]; /*!< values of the last measuring.  */
+}
+bench_counters_t;
+
+/*!
+ * @brief One benchmark case.
+ */
+typedef struct
+{
+	const char* name;                /*!< name of the case.                  */
+	void (*prepare) (list_t, size_t); /*!< function which prepares list.
+	                                       Can be NULL.                       */
+	size_t (*run) (list_t, size_t);   /*!< measured function. It returns
+	                                       amount of performed operations.    */
+}
+bench_case_t;
+
+
+
+
+#ifdef __linux__
+
+/*!
+ * @brief Open one hardware counter.
+ *
+ * @return Descriptor of counter or -1 if it is unavailable.
+ */
+static int bench_open_counter
+(
+	unsigned type,  /*!< [in] perf event type.                               */
+	unsigned long long config /*!< [in] perf event config.                   */
+)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof attr);
+
+	attr.size           = sizeof attr;
+	attr.type           = type;
+	attr.config         = config;
+	attr.disabled       = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv     = 1;
+
+	return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+#	define BENCH_CACHE_CONFIG(CACHE_, RESULT_)                                     \
+		((CACHE_) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | ((RESULT_) << 16))
+
+#endif // defined __linux__
+
+/*!
+ * @brief Open all hardware counters which are available.
+ */
+static void bench_counters_open
+(
+	bench_counters_t* cnt /*!< [out] counters.                               */
+)
+{
+	assert (cnt);
+
+	for (size_t i = 0; i < BENCH_COUNTERS_NUM; ++i)
+		cnt->fds[i] = -1;
+
+#ifdef __linux__
+	cnt->fds[BENCH_CYCLES] =
+		bench_open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	cnt->fds[BENCH_INSTRUCTIONS] =
+		bench_open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	cnt->fds[BENCH_L1D_MISSES] =
+		bench_open_counter(PERF_TYPE_HW_CACHE,
+		                   BENCH_CACHE_CONFIG(PERF_COUNT_HW_CACHE_L1D,
+		                                      PERF_COUNT_HW_CACHE_RESULT_MISS));
+	cnt->fds[BENCH_LLC_MISSES] =
+		bench_open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	cnt->fds[BENCH_DTLB_MISSES] =
+		bench_open_counter(PERF_TYPE_HW_CACHE,
+		                   BENCH_CACHE_CONFIG(PERF_COUNT_HW_CACHE_DTLB,
+		                                      PERF_COUNT_HW_CACHE_RESULT_MISS));
+	cnt->fds[BENCH_BRANCH_MISS] =
+		bench_open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif // defined __linux__
+}
+
+/*!
+ * @brief Close all opened hardware counters.
+ */
+static void bench_counters_close
+(
+	bench_counters_t* cnt /*!< [in,out] counters.                            */
+)
+{
+	assert (cnt);
+
+	for (size_t i = 0; i < BENCH_COUNTERS_NUM; ++i)
+		if (cnt->fds[i] >= 0)
+			close(cnt->fds[i]);
+}
+
+/*!
+ * @brief Reset and enable all opened counters.
+ */
+static void bench_counters_start
+(
+	bench_counters_t* cnt /*!< [in,out] counters.                            */
+)
+{
+	assert (cnt);
+
+#ifdef __linux__
+	for (size_t i = 0; i < BENCH_COUNTERS_NUM; ++i)
+	{
+		if (cnt->fds[i] < 0)
+			continue;
+
+		ioctl(cnt->fds[i], PERF_EVENT_IOC_RESET,  0);
+		ioctl(cnt->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif // defined __linux__
+}
+
+/*!
+ * @brief Disable all opened counters and read their values.
+ */
+static void bench_counters_stop
+(
+	bench_counters_t* cnt /*!< [in,out] counters.                            */
+)
+{
+	assert (cnt);
+
+	for (size_t i = 0; i < BENCH_COUNTERS_NUM; ++i)
+	{
+		cnt->values[i] = 0;
+		if (cnt->fds[i] < 0)
+			continue;
+
+#ifdef __linux__
+		ioctl(cnt->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+#endif // defined __linux__
+		if (read(cnt->fds[i], &cnt->values[i], sizeof cnt->values[i])
+		    != (ssize_t) sizeof cnt->values[i])
+			cnt->values[i] = 0;
+	}
+}
+
+/*!
+ * @brief Get current time in seconds.
+ *
+ * @return Monotonic time in seconds.
+ */
+static double bench_time (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+
+
+
+static void bench_fill_tail (list_t lst, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		list_insert_to_tail(lst, &i);
+}
+
+
+static void bench_fill_shuffled (list_t lst, size_t n)
+{
+	srand(42);
+	for (size_t i = 0; i < n; ++i)
+	{
+		list_iterator_t it = (i) ? (list_iterator_t) rand() % i + 1 : 0;
+		list_insert_after(lst, it, &i);
+	}
+}
+
+
+static size_t bench_insert_to_tail (list_t lst, size_t n)
+{
+	bench_fill_tail(lst, n);
+	return n;
+}
+
+
+static size_t bench_insert_to_head (list_t lst, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		list_insert_to_head(lst, &i);
+
+	return n;
+}
+
+
+static size_t bench_iterate (list_t lst, size_t n)
+{
+	size_t sum = 0;
+	for (list_iterator_t it = list_head(lst); it; it = list_next(lst, it))
+		sum += *(size_t*) list_get(lst, it);
+
+	volatile size_t sink = sum;
+	(void) sink;
+	return n;
+}
+
+
+static size_t bench_find (list_t lst, size_t n)
+{
+	size_t searches = 16;
+	for (size_t i = 0; i < searches; ++i)
+	{
+		size_t val = n - 1 - i;
+		list_find(lst, &val);
+	}
+
+	return searches * n;
+}
+
+
+static size_t bench_normalize (list_t lst, size_t n)
+{
+	list_normalize(lst);
+	return n;
+}
+
+
+static size_t bench_erase_all (list_t lst, size_t n)
+{
+	list_iterator_t it = list_head(lst);
+	while (list_size(lst))
+		list_erase(lst, &it);
+
+	return n;
+}
+
+
+static const bench_case_t BENCH_CASES[] =
+{
+	{"insert_to_tail",       NULL,                bench_insert_to_tail},
+	{"insert_to_head",       NULL,                bench_insert_to_head},
+	{"iterate_normalized",   bench_fill_tail,     bench_iterate},
+	{"iterate_shuffled",     bench_fill_shuffled, bench_iterate},
+	{"find_normalized",      bench_fill_tail,     bench_find},
+	{"normalize_shuffled",   bench_fill_shuffled, bench_normalize},
+	{"erase_from_head",      bench_fill_tail,     bench_erase_all},
+};
+
+
+
+
+/*!
+ * @brief Run one benchmark case and print its results.
+ */
+static void bench_run_case
+(
+	const bench_case_t* bc,  /*!< [in]     benchmark case.                   */
+	size_t              n,   /*!< [in]     amount of elements.               */
+	bench_counters_t*   cnt  /*!< [in,out] counters or NULL.                 */
+)
+{
+	assert (bc);
+
+	list_t lst = list_create(1, NULL, size_t);
+	if (!lst)
+	{
+		list_perror(LIST_ALLOC_ERR, stderr);
+		return;
+	}
+
+	if (bc->prepare)
+		bc->prepare(lst, n);
+
+	if (cnt)
+		bench_counters_start(cnt);
+	double start = bench_time();
+
+	size_t ops = bc->run(lst, n);
+
+	double elapsed = bench_time() - start;
+	if (cnt)
+		bench_counters_stop(cnt);
+
+	lst = list_destroy(lst);
+
+	ops = (ops) ? ops : 1;
+	printf("%-20s %12zu ops %10.3f ms %10.2f ns/op",
+	       bc->name, ops, elapsed * 1e3, elapsed * 1e9 / (double) ops);
+
+	if (cnt)
+	{
+		for (size_t i = 0; i < BENCH_COUNTERS_NUM; ++i)
+		{
+			if (cnt->fds[i] < 0)
+				printf(" %s/op=n/a", BENCH_COUNTER_NAMES[i]);
+			else
+				printf(" %s/op=%.3f", BENCH_COUNTER_NAMES[i],
+				       (double) cnt->values[i] / (double) ops);
+		}
+	}
+
+	putchar('\n');
+}
+
+
+int main (int argc, char* argv[])
+{
+	bool   use_perf = false;
+	size_t n        = BENCH_DEFAULT_N;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "--perf"))
+			use_perf = true;
+		else
+			n = strtoull(argv[i], NULL, 10);
+	}
+
+	if (!n)
+	{
+		fprintf(stderr, "Usage: %s [--perf] [elements amount]\n", argv[0]);
+		return 1;
+	}
+
+	bench_counters_t cnt;
+	if (use_perf)
+	{
+		bench_counters_open(&cnt);
+
+		size_t opened = 0;
+		for (size_t i = 0; i < BENCH_COUNTERS_NUM; ++i)
+			opened += cnt.fds[i] >= 0;
+
+		if (!opened)
+			fprintf(stderr, "Hardware counters are unavailable, "
+			                "only wall time will be measured.\n");
+	}
+
+	for (size_t i = 0; i < sizeof BENCH_CASES / sizeof *BENCH_CASES; ++i)
+		bench_run_case(&BENCH_CASES[i], n, (use_perf) ? &cnt : NULL);
+
+	if (use_perf)
+		bench_counters_close(&cnt);
+
+	return 0;
+}
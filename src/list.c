@@ -3,6 +3,7 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <memory.h>
 
@@ -28,6 +29,74 @@ static void list_print_bytes
 		fprintf(stream, "%hhx", *((unsigned char*) elem + i));
 }
 
+/*!
+ * @brief Check whether the slot is selected to dump.
+ *
+ * @return Is slot selected.
+ */
+static bool list_dump_shown
+(
+	const unsigned char* shown, /*!< [in] bitmap of selected slots or NULL
+	                                      if all slots are selected.         */
+	size_t               i      /*!< [in] index of slot.                     */
+)
+{
+	return !shown || (shown[i / 8] >> (i % 8) & 1);
+}
+
+/*!
+ * @brief Select slots to dump according to options.
+ *
+ * @return Bitmap of selected slots or NULL if all slots are selected
+ * or allocation error has been occurred.
+ */
+static unsigned char* list_dump_select
+(
+	const list_t            lst, /*!< [in] list.                             */
+	const list_dump_opts_t* opts /*!< [in] options of dump.                  */
+)
+{
+	if (!opts->window && opts->sample_step < 2)
+		return NULL;
+
+	if (!lst->data || !lst->nexts || !lst->prevs)
+		return NULL;
+
+	unsigned char* shown = (unsigned char*) calloc(lst->capacity / 8 + 1, 1);
+	if (!shown)
+		return NULL;
+
+#define LIST_DUMP_SHOW(IT_) shown[(IT_) / 8] |= (unsigned char) (1 << (IT_) % 8)
+
+	LIST_DUMP_SHOW(0);
+
+	if (opts->sample_step > 1)
+		for (size_t i = 0; i < lst->capacity; i += opts->sample_step)
+			LIST_DUMP_SHOW(i);
+
+	if (opts->window && opts->center < lst->capacity)
+	{
+		LIST_DUMP_SHOW(opts->center);
+
+		list_iterator_t next = opts->center;
+		list_iterator_t prev = opts->center;
+		for (size_t i = 0; i < opts->window; ++i)
+		{
+			next = (next < lst->capacity) ? lst->nexts[next] : lst->capacity;
+			prev = (prev < lst->capacity) ? lst->prevs[prev] : lst->capacity;
+
+			if (next < lst->capacity)
+				LIST_DUMP_SHOW(next);
+			if (prev < lst->capacity)
+				LIST_DUMP_SHOW(prev);
+		}
+	}
+
+#undef LIST_DUMP_SHOW
+
+	return shown;
+}
+
 /*!
  * @brief Write list dump to .dot file.
  */
@@ -35,6 +104,8 @@ static void list_write_dump_to_dot
 (
 	const list_t lst,       /*!< [in]     list.                              */
 	FILE* dump,             /*!< [in,out] dump .dot file.                    */
+	const unsigned char* shown, /*!< [in] bitmap of slots to dump or NULL
+	                                      if all slots are dumped.           */
 	const char*  lst_name,  /*!< [in]     name of the list variable.         */
 	size_t       line,      /*!< [in]     line where dump function
 	                                      was called.                        */
@@ -68,6 +139,9 @@ static void list_write_dump_to_dot
 
 	for (size_t i = 1; i < lst->capacity; ++i)
 	{
+		if (!list_dump_shown(shown, i))
+			continue;
+
 		if (lst->prevs[i] == i)
 		{
 			fprintf(dump, "\tL%zd [color = \"orange\","
@@ -102,36 +176,322 @@ static void list_write_dump_to_dot
 	fprintf(dump, "\n\tnode [color = \"black\",fontcolor = \"black\"];\n"
 		"\tLH0");
 	for (size_t i = 1; i <= lst->capacity; ++i)
-		fprintf(dump, " -> LH%zd", i);
+		if (i == lst->capacity || list_dump_shown(shown, i))
+			fprintf(dump, " -> LH%zd", i);
 	fprintf(dump, " [weight = 100];\n\n");
 
 	for (size_t i = 0; i <= lst->capacity; ++i)
 	{
-		fprintf(dump, "\t{rank = same; LH%zd; L%zd}\n", i, i);
+		if (i == lst->capacity || list_dump_shown(shown, i))
+			fprintf(dump, "\t{rank = same; LH%zd; L%zd}\n", i, i);
 	}
 
 	for (size_t i = 0; i < lst->capacity; ++i)
 	{
-		fprintf(dump, "\tL%zd:<LN%zd> -> L%zd:<LN%zd> [color = %s];\n",
-			i, i,
-			(lst->nexts[i] < lst->capacity) ? lst->nexts[i] : lst->capacity,
-			(lst->nexts[i] < lst->capacity) ? lst->nexts[i] : lst->capacity,
-			(lst->prevs[i] == i) ? "\"white\", style = \"dotted\"" : "\"blue\"");
+		if (!list_dump_shown(shown, i))
+			continue;
+
+		size_t next = (lst->nexts[i] < lst->capacity) ? lst->nexts[i]
+		                                              : lst->capacity;
+		size_t prev = (lst->prevs[i] < lst->capacity) ? lst->prevs[i]
+		                                              : lst->capacity;
 
-		if (lst->prevs[i] != i)
+		if (next == lst->capacity || list_dump_shown(shown, next))
+		{
+			fprintf(dump, "\tL%zd:<LN%zd> -> L%zd:<LN%zd> [color = %s];\n",
+				i, i, next, next,
+				(lst->prevs[i] == i) ? "\"white\", style = \"dotted\""
+				                     : "\"blue\"");
+		}
+
+		if (lst->prevs[i] != i
+		    && (prev == lst->capacity || list_dump_shown(shown, prev)))
 		{
 			fprintf(dump, "\tL%zd:<LP%zd> -> L%zd:<LP%zd> [color = \"pink\"];\n",
-				i, i,
-				(lst->prevs[i] < lst->capacity) ? lst->prevs[i]
-					: lst->capacity,
-				(lst->prevs[i] < lst->capacity) ? lst->prevs[i]
-					: lst->capacity);
+				i, i, prev, prev);
 		}
 	}
 
 	fprintf(dump, "}\n");
 }
 
+/*!
+ * @brief Magic number of binary state dump.
+ */
+#define LIST_STATE_MAGIC "LSTS"
+
+/*!
+ * @brief Version of binary state dump format.
+ */
+#define LIST_STATE_VERSION ((uint32_t) 1)
+
+/*!
+ * @brief Size of buffer which is used to format numbers.
+ */
+#define LIST_FORMAT_BUFFER ((size_t) 4096)
+
+/*!
+ * @brief Magic number of delta dump.
+ */
+#define LIST_DELTA_MAGIC "LSTD"
+
+/*!
+ * @brief Header of binary state dump.
+ */
+typedef struct
+{
+	char     magic[4];   /*!< LIST_STATE_MAGIC.                              */
+	uint32_t version;    /*!< LIST_STATE_VERSION.                            */
+	uint64_t index_size; /*!< size of one element of nexts and prevs.        */
+	uint64_t elem_size;  /*!< size of one element.                           */
+	uint64_t size;       /*!< amount of elements including virtual one.      */
+	uint64_t capacity;   /*!< capacity including virtual element.            */
+	uint64_t first_free; /*!< index of first free element.                   */
+	uint64_t head;       /*!< head of the list.                              */
+	uint64_t tail;       /*!< tail of the list.                              */
+	uint64_t normalized; /*!< is list normalized.                            */
+}
+list_state_header_t;
+
+/*!
+ * @brief Header of delta dump.
+ */
+typedef struct
+{
+	list_state_header_t state;  /*!< state of the list.                     */
+	uint64_t            amount; /*!< amount of slot records.                 */
+}
+list_delta_header_t;
+
+/*!
+ * @brief Get size of bitmap of changed slots.
+ *
+ * @return Size in bytes.
+ */
+static size_t list_dirty_size
+(
+	size_t capacity /*!< [in] capacity of the list.                          */
+)
+{
+	return capacity / 8 + 1;
+}
+
+/*!
+ * @brief Mark slot as changed.
+ */
+static void list_mark_dirty
+(
+	list_t                lst, /*!< [in,out] list.                           */
+	const list_iterator_t it   /*!< [in]     index of slot.                  */
+)
+{
+	if (lst->dirty)
+		lst->dirty[it / 8] |= (unsigned char) (1 << it % 8);
+
+	if (lst->chunks)
+		lst->chunks[it / LIST_CHUNK_SLOTS / 8]
+			|= (unsigned char) (1 << it / LIST_CHUNK_SLOTS % 8);
+}
+
+/*!
+ * @brief Mark slots first..last - 1 as changed.
+ */
+static void list_mark_dirty_range
+(
+	list_t lst,   /*!< [in,out] list.                                        */
+	size_t first, /*!< [in]     index of the first slot.                     */
+	size_t last   /*!< [in]     index after the last slot.                   */
+)
+{
+	if (first >= last)
+		return;
+
+	if (lst->dirty)
+	{
+		size_t i = first;
+		for (; i < last && i % 8; ++i)
+			lst->dirty[i / 8] |= (unsigned char) (1 << i % 8);
+
+		size_t whole = (last - i) / 8;
+		memset(lst->dirty + i / 8, 0xff, whole);
+
+		for (i += whole * 8; i < last; ++i)
+			lst->dirty[i / 8] |= (unsigned char) (1 << i % 8);
+	}
+
+	if (lst->chunks)
+		for (size_t i = first / LIST_CHUNK_SLOTS;
+		     i <= (last - 1) / LIST_CHUNK_SLOTS;
+		     ++i)
+			lst->chunks[i / 8] |= (unsigned char) (1 << i % 8);
+}
+
+/*!
+ * @brief Mark all slots as changed.
+ */
+static void list_mark_all_dirty
+(
+	list_t lst /*!< [in,out] list.                                           */
+)
+{
+	if (lst->dirty)
+		memset(lst->dirty, 0xff, list_dirty_size(lst->capacity));
+
+	if (lst->chunks)
+		memset(lst->chunks, 0xff, LIST_CHUNKS_SIZE(lst->capacity));
+}
+
+/*!
+ * @brief Fill header of binary dump with fields of the list.
+ */
+static void list_fill_state_header
+(
+	const list_t         lst,    /*!< [in]  list.                            */
+	list_state_header_t* header, /*!< [out] header.                          */
+	const char*          magic   /*!< [in]  magic number.                    */
+)
+{
+	memset(header, 0, sizeof *header);
+	memcpy(header->magic, magic, sizeof header->magic);
+
+	header->version    = LIST_STATE_VERSION;
+	header->index_size = sizeof *lst->nexts;
+	header->elem_size  = lst->elem_size;
+	header->size       = lst->size;
+	header->capacity   = lst->capacity;
+	header->first_free = lst->first_free;
+	header->head       = lst->head;
+	header->tail       = lst->tail;
+	header->normalized = lst->normalized;
+}
+
+/*!
+ * @brief Check header of binary dump.
+ *
+ * @return Is header correct.
+ */
+static bool list_check_state_header
+(
+	const list_state_header_t* header, /*!< [in] header.                     */
+	const char*                magic   /*!< [in] magic number.               */
+)
+{
+	return !memcmp(header->magic, magic, sizeof header->magic)
+	       && header->version    == LIST_STATE_VERSION
+	       && header->index_size == sizeof (size_t)
+	       && header->capacity;
+}
+
+/*!
+ * @brief Max length of text of one number.
+ */
+#define LIST_NUMBER_MAX ((size_t) 32)
+
+/*!
+ * @brief Convert unsigned number to decimal digits.
+ *
+ * @return Amount of written characters.
+ */
+static size_t list_format_unsigned
+(
+	unsigned long long val, /*!< [in]  number.                               */
+	char*              out  /*!< [out] at least LIST_NUMBER_MAX characters.  */
+)
+{
+	char   digits[LIST_NUMBER_MAX];
+	size_t len = 0;
+	do
+	{
+		digits[len++] = (char) ('0' + val % 10);
+		val /= 10;
+	}
+	while (val);
+
+	for (size_t i = 0; i < len; ++i)
+		out[i] = digits[len - 1 - i];
+
+	return len;
+}
+
+/*!
+ * @brief Convert signed number to decimal digits.
+ *
+ * @return Amount of written characters.
+ */
+static size_t list_format_signed
+(
+	long long val, /*!< [in]  number.                                        */
+	char*     out  /*!< [out] at least LIST_NUMBER_MAX characters.           */
+)
+{
+	if (val >= 0)
+		return list_format_unsigned((unsigned long long) val, out);
+
+	*out = '-';
+	return 1 + list_format_unsigned(0ull - (unsigned long long) val, out + 1);
+}
+
+/*!
+ * @brief Write array of indexes as comma separated decimal numbers.
+ */
+static void list_write_indexes
+(
+	const size_t* indexes, /*!< [in]     array.                              */
+	size_t        amount,  /*!< [in]     size of array.                      */
+	FILE*         stream   /*!< [in,out] output stream.                      */
+)
+{
+	char   buffer[LIST_FORMAT_BUFFER];
+	size_t used = 0;
+
+	for (size_t i = 0; i < amount; ++i)
+	{
+		if (used + LIST_NUMBER_MAX + 1 > sizeof buffer)
+		{
+			fwrite(buffer, 1, used, stream);
+			used = 0;
+		}
+
+		if (i)
+			buffer[used++] = ',';
+
+		used += list_format_unsigned(indexes[i], buffer + used);
+	}
+
+	fwrite(buffer, 1, used, stream);
+}
+
+/*!
+ * @brief Write bytes as a string of hexadecimal digits.
+ */
+static void list_write_hex
+(
+	const void* bytes,  /*!< [in]     bytes.                                 */
+	size_t      amount, /*!< [in]     amount of bytes.                       */
+	FILE*       stream  /*!< [in,out] output stream.                         */
+)
+{
+	static const char DIGITS[] = "0123456789abcdef";
+
+	char   buffer[LIST_FORMAT_BUFFER];
+	size_t used = 0;
+
+	for (size_t i = 0; i < amount; ++i)
+	{
+		if (used + 2 > sizeof buffer)
+		{
+			fwrite(buffer, 1, used, stream);
+			used = 0;
+		}
+
+		unsigned char byte = ((const unsigned char*) bytes)[i];
+		buffer[used++] = DIGITS[byte >> 4];
+		buffer[used++] = DIGITS[byte & 0xf];
+	}
+
+	fwrite(buffer, 1, used, stream);
+}
+
 /*!
  * @brief Prepare first free element to making it used.
  *
@@ -159,6 +519,147 @@ static list_error_t list_remove_first_free
 	return LIST_NO_ERR;
 }
 
+/*!
+ * @brief Take free slot and link it after the element.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_link_after
+(
+	list_t                lst,  /*!< [in,out] list.                          */
+	const list_iterator_t it,   /*!< [in]     an iterator.                   */
+	list_iterator_t*      place /*!< [out]    linked slot.                   */
+)
+{
+	list_iterator_t place_to_insert;
+	list_error_t err = list_remove_first_free(lst, &place_to_insert);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	lst->nexts[place_to_insert]             = lst->nexts[it];
+	lst->nexts[it]                          = place_to_insert;
+	lst->prevs[place_to_insert]             = it;
+	lst->prevs[lst->nexts[place_to_insert]] = place_to_insert;
+
+	if (lst->nexts[place_to_insert] == 0)
+		lst->tail = place_to_insert;
+
+	if (lst->nexts[place_to_insert] != 0 || place_to_insert != lst->size - 1)
+		lst->normalized = false;
+
+	if (lst->prevs[place_to_insert] == 0)
+		lst->head = place_to_insert;
+
+	list_mark_dirty(lst, it);
+	list_mark_dirty(lst, place_to_insert);
+	list_mark_dirty(lst, lst->nexts[place_to_insert]);
+
+	*place = place_to_insert;
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Change size of heap arrays of the list keeping the first slots.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_heap_resize
+(
+	list_t lst,         /*!< [in,out] list.                                  */
+	size_t new_capacity /*!< [in]     new capacity including virtual element.*/
+)
+{
+	void*   new_data  = calloc(new_capacity, lst->elem_size);
+	size_t* new_nexts = (size_t*) calloc(new_capacity, sizeof *lst->nexts);
+	size_t* new_prevs = (size_t*) calloc(new_capacity, sizeof *lst->prevs);
+
+	if (!new_data || !new_nexts || !new_prevs)
+	{
+		free(new_data);
+		free(new_nexts);
+		free(new_prevs);
+		return LIST_ALLOC_ERR;
+	}
+
+	size_t copy_capacity = (new_capacity < lst->capacity) ? new_capacity
+	                                                      : lst->capacity;
+
+	if (lst->relocate)
+	{
+		// Only elements are relocated, free slots are runs' separators.
+		for (size_t i = 1; i < copy_capacity; ++i)
+		{
+			size_t run = i;
+			while (run < copy_capacity && lst->prevs[run] != run)
+				++run;
+
+			if (run > i)
+				lst->relocate((char*) new_data  + i * lst->elem_size,
+				              (char*) lst->data + i * lst->elem_size,
+				              run - i);
+			i = run;
+		}
+	}
+	else
+		memcpy(new_data, lst->data, copy_capacity * lst->elem_size);
+
+	memcpy(new_nexts, lst->nexts, copy_capacity * sizeof *lst->nexts);
+	memcpy(new_prevs, lst->prevs, copy_capacity * sizeof *lst->prevs);
+
+	free(lst->data);
+	free(lst->nexts);
+	free(lst->prevs);
+
+	lst->data  = new_data;
+	lst->nexts = new_nexts;
+	lst->prevs = new_prevs;
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Copy one element.
+ *
+ * Common sizes are copied by memcpy() with constant size which compiler
+ * replaces by direct loads and stores.
+ */
+static inline void list_copy_val
+(
+	void*       dst,      /*!< [out] destination.                            */
+	const void* src,      /*!< [in]  source.                                 */
+	size_t      elem_size /*!< [in]  size of element.                        */
+)
+{
+	switch (elem_size)
+	{
+		case 1:  memcpy(dst, src, 1);  break;
+		case 2:  memcpy(dst, src, 2);  break;
+		case 4:  memcpy(dst, src, 4);  break;
+		case 8:  memcpy(dst, src, 8);  break;
+		case 16: memcpy(dst, src, 16); break;
+		default: memcpy(dst, src, elem_size);
+	}
+}
+
+/*!
+ * @brief Move value from one slot of the list to another one.
+ */
+static void list_move_val
+(
+	list_t                lst, /*!< [in,out] list.                           */
+	const list_iterator_t dst, /*!< [in]     uninitialized slot.             */
+	const list_iterator_t src  /*!< [in]     slot with value.                */
+)
+{
+	char* data = (char*) lst->data;
+	if (lst->relocate)
+		lst->relocate(data + dst * lst->elem_size,
+		              data + src * lst->elem_size, 1);
+	else
+		list_copy_val(data + dst * lst->elem_size,
+		              data + src * lst->elem_size, lst->elem_size);
+}
+
 /*!
  * @brief Swap two values in data array of the list.
  */
@@ -169,14 +670,247 @@ static void list_swap_vals
 	const list_iterator_t it2  /*!< [in]     second iterator.                */
 )
 {
-	memcpy(lst->data,
-	       (char*) lst->data + it1 * lst->elem_size, lst->elem_size);
-	memcpy((char*) lst->data + it1 * lst->elem_size,
-	       (char*) lst->data + it2 * lst->elem_size, lst->elem_size);
-	memcpy((char*) lst->data + it2 * lst->elem_size,
-	       lst->data, lst->elem_size);
+	list_move_val(lst, 0,   it1);
+	list_move_val(lst, it1, it2);
+	list_move_val(lst, it2, 0);
+}
+
+
+#ifdef LIST_EVENTS
+
+/*!
+ * @brief Buffer of events which are passed to observer at once.
+ */
+typedef struct
+{
+	list_event_t events[LIST_EVENTS_BATCH]; /*!< buffered events.            */
+	size_t       amount;                    /*!< amount of buffered events.  */
+}
+list_event_batch_t;
+
+/*!
+ * @brief Pass all buffered events to observer.
+ */
+static void list_event_flush
+(
+	list_t              lst,  /*!< [in]     list.                            */
+	list_event_batch_t* batch /*!< [in,out] buffer of events.                */
+)
+{
+	if (batch->amount && lst->observer)
+		lst->observer(lst, batch->events, batch->amount, lst->observer_ctx);
+
+	batch->amount = 0;
+}
+
+/*!
+ * @brief Add event to buffer. Buffer is flushed when it is full.
+ */
+static void list_event_push
+(
+	list_t              lst,   /*!< [in]     list.                           */
+	list_event_batch_t* batch, /*!< [in,out] buffer of events.               */
+	list_event_type_t   type,  /*!< [in]     type of event.                  */
+	size_t              from,  /*!< [in]     first argument of event.        */
+	size_t              to     /*!< [in]     second argument of event.       */
+)
+{
+	if (!lst->observer)
+		return;
+
+	if (batch->amount == LIST_EVENTS_BATCH)
+		list_event_flush(lst, batch);
+
+	batch->events[batch->amount].type = type;
+	batch->events[batch->amount].from = from;
+	batch->events[batch->amount].to   = to;
+	++batch->amount;
+}
+
+/*!
+ * @brief Pass one event to observer.
+ */
+static void list_event_notify
+(
+	list_t            lst,  /*!< [in] list.                                  */
+	list_event_type_t type, /*!< [in] type of event.                         */
+	size_t            from, /*!< [in] first argument of event.               */
+	size_t            to    /*!< [in] second argument of event.              */
+)
+{
+	if (!lst->observer)
+		return;
+
+	list_event_t event = {type, from, to};
+	lst->observer(lst, &event, 1, lst->observer_ctx);
+}
+
+#	define LIST_EVENT(TYPE_, FROM_, TO_)                                         \
+		list_event_notify(lst, (TYPE_), (FROM_), (TO_))
+#	define LIST_EVENT_BATCH_BEGIN()                                              \
+		list_event_batch_t events_batch_; events_batch_.amount = 0
+#	define LIST_EVENT_BATCH_PUSH(TYPE_, FROM_, TO_)                              \
+		list_event_push(lst, &events_batch_, (TYPE_), (FROM_), (TO_))
+#	define LIST_EVENT_BATCH_END() list_event_flush(lst, &events_batch_)
+#	define LIST_OBSERVED()        (lst->observer != NULL)
+#else
+#	define LIST_EVENT(TYPE_, FROM_, TO_)            ((void) (FROM_), (void) (TO_))
+#	define LIST_EVENT_BATCH_BEGIN()                 ((void) 0)
+#	define LIST_EVENT_BATCH_PUSH(TYPE_, FROM_, TO_) ((void) 0)
+#	define LIST_EVENT_BATCH_END()                   ((void) 0)
+#	define LIST_OBSERVED()                          false
+#endif // defined LIST_EVENTS
+
+
+#ifdef LIST_REGISTRY
+
+/*!
+ * @brief Entry of the registry of live lists.
+ */
+typedef struct
+{
+	list_t      lst; /*!< registered list.                                   */
+	const char* tag; /*!< name tag of the list. Can be NULL.                 */
+}
+list_registry_entry_t;
+
+static list_registry_entry_t* list_registry          = NULL;
+static size_t                 list_registry_size     = 0;
+static size_t                 list_registry_capacity = 0;
+
+/*!
+ * @brief Add list to the registry of live lists.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_registry_add
+(
+	list_t lst /*!< [in] list.                                               */
+)
+{
+	assert (lst);
+
+	if (list_registry_size == list_registry_capacity)
+	{
+		size_t new_capacity = (list_registry_capacity)
+		                      ? list_registry_capacity * CAPACITY_COEFF : 16;
+		list_registry_entry_t* new_registry = (list_registry_entry_t*)
+			realloc(list_registry, new_capacity * sizeof *list_registry);
+		if (!new_registry)
+			return LIST_ALLOC_ERR;
+
+		list_registry          = new_registry;
+		list_registry_capacity = new_capacity;
+	}
+
+	list_registry[list_registry_size].lst = lst;
+	list_registry[list_registry_size].tag = NULL;
+	++list_registry_size;
+
+	return LIST_NO_ERR;
 }
 
+/*!
+ * @brief Find list in the registry of live lists.
+ *
+ * @return Pointer to registry entry or NULL if list isn't registered.
+ */
+static list_registry_entry_t* list_registry_find
+(
+	const list_t lst /*!< [in] list.                                         */
+)
+{
+	for (size_t i = 0; i < list_registry_size; ++i)
+		if (list_registry[i].lst == lst)
+			return &list_registry[i];
+
+	return NULL;
+}
+
+/*!
+ * @brief Remove list from the registry of live lists.
+ */
+static void list_registry_remove
+(
+	const list_t lst /*!< [in] list.                                         */
+)
+{
+	list_registry_entry_t* entry = list_registry_find(lst);
+	if (!entry)
+		return;
+
+	*entry = list_registry[--list_registry_size];
+	if (!list_registry_size)
+	{
+		free(list_registry);
+		list_registry          = NULL;
+		list_registry_capacity = 0;
+	}
+}
+
+/*!
+ * @brief Compare registry entries by wasted bytes in descending order.
+ */
+static int list_registry_cmp (const void* lhs, const void* rhs)
+{
+	list_memory_usage_t lhs_usage;
+	list_memory_usage_t rhs_usage;
+	list_memory_usage(((const list_registry_entry_t*) lhs)->lst, &lhs_usage);
+	list_memory_usage(((const list_registry_entry_t*) rhs)->lst, &rhs_usage);
+
+	return (lhs_usage.free < rhs_usage.free)
+	       - (lhs_usage.free > rhs_usage.free);
+}
+
+#endif // defined LIST_REGISTRY
+
+#define LIST_SWAP_MAP(IT_) (((IT_) == it1) ? it2 : ((IT_) == it2) ? it1 : (IT_))
+
+/*!
+ * @brief Exchange two slots of the list keeping order of elements.
+ *
+ * Slot it1 can be free. In this case free list becomes broken
+ * and must be rebuilt by caller.
+ */
+static void list_swap_slots
+(
+	list_t                lst, /*!< [in,out] list.                           */
+	const list_iterator_t it1, /*!< [in]     first iterator.                 */
+	const list_iterator_t it2  /*!< [in]     second iterator of an element.  */
+)
+{
+	assert (it1 && it2 && it1 != it2);
+
+	if (lst->prevs[it1] == it1)
+	{
+		list_move_val(lst, it1, it2);
+
+		lst->nexts[it1]             = lst->nexts[it2];
+		lst->prevs[it1]             = lst->prevs[it2];
+		lst->nexts[lst->prevs[it1]] = it1;
+		lst->prevs[lst->nexts[it1]] = it1;
+		lst->prevs[it2]             = it2;
+		return;
+	}
+
+	list_iterator_t next1 = lst->nexts[it1];
+	list_iterator_t prev1 = lst->prevs[it1];
+
+	lst->nexts[it1] = LIST_SWAP_MAP(lst->nexts[it2]);
+	lst->prevs[it1] = LIST_SWAP_MAP(lst->prevs[it2]);
+	lst->nexts[it2] = LIST_SWAP_MAP(next1);
+	lst->prevs[it2] = LIST_SWAP_MAP(prev1);
+
+	lst->nexts[lst->prevs[it1]] = it1;
+	lst->prevs[lst->nexts[it1]] = it1;
+	lst->nexts[lst->prevs[it2]] = it2;
+	lst->prevs[lst->nexts[it2]] = it2;
+
+	list_swap_vals(lst, it1, it2);
+}
+
+#undef LIST_SWAP_MAP
+
 
 list_t list_create_func_ (size_t start_capacity,
                           void (*print_func) (const void*, FILE*),
@@ -201,7 +935,7 @@ list_t list_create_func_ (size_t start_capacity,
 	lst->size            = 1;
 	lst->capacity        = start_capacity;
 	lst->elem_size       = elem_size;
-	lst->first_free      = 1;
+	lst->first_free      = (start_capacity > 1) ? 1 : 0;
 	lst->head            = 0;
 	lst->tail            = 0;
 	lst->normalized      = true;
@@ -214,6 +948,11 @@ list_t list_create_func_ (size_t start_capacity,
 		lst->prevs[i] = i;
 	}
 
+#ifdef LIST_REGISTRY
+	if (list_registry_add(lst) != LIST_NO_ERR)
+		return list_destroy(lst);
+#endif // defined LIST_REGISTRY
+
 	return lst;
 }
 
@@ -223,9 +962,23 @@ list_t list_destroy (list_t lst)
 	if (!lst)
 		return NULL;
 
-	free(lst->data);
-	free(lst->nexts);
-	free(lst->prevs);
+#ifdef LIST_REGISTRY
+	list_registry_remove(lst);
+#endif // defined LIST_REGISTRY
+
+	if (lst->storage)
+	{
+		lst->storage->release(lst);
+	}
+	else
+	{
+		free(lst->data);
+		free(lst->nexts);
+		free(lst->prevs);
+	}
+
+	free(lst->dirty);
+	free(lst->chunks);
 	free(lst);
 
 	return NULL;
@@ -244,37 +997,69 @@ void* list_get (const list_t lst, const list_iterator_t it)
 }
 
 
-list_error_t list_insert_after (list_t lst,
-                                const list_iterator_t it, const void* value)
+list_error_t list_insert_after (list_t lst,
+                                const list_iterator_t it, const void* value)
+{
+	assert (lst);
+	assert (value);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (!list_check_iterator(lst, it))
+		return LIST_BAD_ITERATOR;
+
+	list_iterator_t place_to_insert;
+	list_error_t err = list_link_after(lst, it, &place_to_insert);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	list_copy_val((char*) lst->data + place_to_insert * lst->elem_size,
+	              value, lst->elem_size);
+
+	LIST_EVENT(LIST_EVENT_INSERT, it, place_to_insert);
+	return LIST_NO_ERR;
+}
+
+
+list_error_t list_emplace_after (list_t lst, const list_iterator_t it,
+                                 list_iterator_t* place)
+{
+	assert (lst);
+	assert (place);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (!list_check_iterator(lst, it))
+		return LIST_BAD_ITERATOR;
+
+	return list_link_after(lst, it, place);
+}
+
+
+void list_emplace_commit (list_t lst, const list_iterator_t place)
 {
 	assert (lst);
-	assert (value);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	assert (place && list_check_iterator(lst, place));
 
-	if (!list_check_iterator(lst, it))
-		return LIST_BAD_ITERATOR;
+	LIST_EVENT(LIST_EVENT_INSERT, lst->prevs[place], place);
+}
 
-	list_iterator_t place_to_insert;
-	list_error_t err = list_remove_first_free(lst, &place_to_insert);
-	if (err != LIST_NO_ERR)
-		return err;
 
-	memcpy((char*) lst->data + place_to_insert * lst->elem_size,
-	       value, lst->elem_size);
-	lst->nexts[place_to_insert]             = lst->nexts[it];
-	lst->nexts[it]                          = place_to_insert;
-	lst->prevs[place_to_insert]             = it;
-	lst->prevs[lst->nexts[place_to_insert]] = place_to_insert;
+list_error_t list_emplace_cancel (list_t lst, list_iterator_t place)
+{
+	assert (lst);
 
-	if (lst->nexts[place_to_insert] == 0)
-		lst->tail = place_to_insert;
-	else
-		lst->normalized = false;
+	// Observer hasn't seen insertion, so erasure isn't passed to it.
+#ifdef LIST_EVENTS
+	list_observer_t observer = lst->observer;
+	lst->observer            = NULL;
+#endif // defined LIST_EVENTS
 
-	if (lst->prevs[place_to_insert] == 0)
-		lst->head = place_to_insert;
+	list_error_t err = list_erase(lst, &place);
 
-	return LIST_NO_ERR;
+#ifdef LIST_EVENTS
+	lst->observer = observer;
+#endif // defined LIST_EVENTS
+
+	return err;
 }
 
 
@@ -417,241 +1202,736 @@ list_error_t list_change_capacity (list_t lst, size_t new_capacity)
 	if (new_capacity < lst->capacity)
 		list_normalize(lst);
 
-	void*   new_data  = calloc(new_capacity, lst->elem_size);
-	size_t* new_nexts = (size_t*) calloc(new_capacity, sizeof *lst->nexts);
-	size_t* new_prevs = (size_t*) calloc(new_capacity, sizeof *lst->prevs);
+	size_t       old_capacity = lst->capacity;
+	list_error_t err          = list_resize_slots(lst, new_capacity - 1);
+	if (err != LIST_NO_ERR)
+		return err;
 
-	if (!new_data || !new_nexts || !new_prevs)
+	// New slots have been marked as changed by resize, links of old ones
+	// are marked only if they are changed.
+	if (new_capacity > old_capacity)
 	{
-		free(new_data);
-		free(new_nexts);
-		free(new_prevs);
+		for (size_t i = old_capacity; i < new_capacity; ++i)
+		{
+			lst->nexts[i] = i + 1;
+			lst->prevs[i] = i;
+		}
+
+		lst->nexts[new_capacity - 1] = lst->first_free;
+		lst->first_free              = old_capacity;
+	}
+	else if (new_capacity < old_capacity)
+	{
+		for (size_t i = lst->size; i < new_capacity; ++i)
+		{
+			size_t next = (i + 1) % new_capacity;
+			if (lst->nexts[i] != next || lst->prevs[i] != i)
+			{
+				lst->nexts[i] = next;
+				lst->prevs[i] = i;
+				list_mark_dirty(lst, i);
+			}
+		}
+
+		lst->first_free = (lst->size < new_capacity) ? lst->size : 0;
+	}
+
+	LIST_EVENT(LIST_EVENT_RESIZE, old_capacity - 1, new_capacity - 1);
+	return LIST_NO_ERR;
+}
+
+
+list_error_t list_resize_slots (list_t lst, size_t new_capacity)
+{
+	assert (lst);
+
+	++new_capacity;
+	if (new_capacity == lst->capacity)
+		return LIST_NO_ERR;
+
+	unsigned char* new_dirty  = (lst->dirty)
+	                            ? (unsigned char*)
+	                              malloc(list_dirty_size(new_capacity))
+	                            : NULL;
+	unsigned char* new_chunks = (lst->chunks)
+	                            ? (unsigned char*)
+	                              malloc(LIST_CHUNKS_SIZE(new_capacity))
+	                            : NULL;
+	if ((lst->dirty && !new_dirty) || (lst->chunks && !new_chunks))
+	{
+		free(new_dirty);
+		free(new_chunks);
 		return LIST_ALLOC_ERR;
 	}
 
-	memcpy(new_data,  lst->data,  new_capacity * lst->elem_size);
-	memcpy(new_nexts, lst->nexts, new_capacity * sizeof *lst->nexts);
-	memcpy(new_prevs, lst->prevs, new_capacity * sizeof *lst->prevs);
+	list_error_t err = (lst->storage) ? lst->storage->resize(lst, new_capacity)
+	                                  : list_heap_resize(lst, new_capacity);
+	if (err != LIST_NO_ERR)
+	{
+		free(new_dirty);
+		free(new_chunks);
+		return err;
+	}
+
+	// Marks of kept slots are kept.
+	size_t old_capacity = lst->capacity;
+	size_t keep         = (new_capacity < old_capacity) ? new_capacity
+	                                                    : old_capacity;
+	if (new_dirty)
+	{
+		memset(new_dirty, 0, list_dirty_size(new_capacity));
+		memcpy(new_dirty, lst->dirty, list_dirty_size(keep));
+	}
+
+	if (new_chunks)
+	{
+		memset(new_chunks, 0, LIST_CHUNKS_SIZE(new_capacity));
+		memcpy(new_chunks, lst->chunks, LIST_CHUNKS_SIZE(keep));
+	}
+
+	free(lst->dirty);
+	free(lst->chunks);
+
+	lst->dirty    = new_dirty;
+	lst->chunks   = new_chunks;
+	lst->capacity = new_capacity;
+
+	list_mark_dirty_range(lst, old_capacity, new_capacity);
+	return LIST_NO_ERR;
+}
+
+
+list_iterator_t list_head (const list_t lst)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	return lst->head;
+}
+
+
+list_iterator_t list_tail (const list_t lst)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	return lst->tail;
+}
+
+
+list_error_t list_erase (list_t lst, list_iterator_t* it)
+{
+	assert (lst);
+	assert (it);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (!list_check_iterator(lst, *it))
+		return LIST_BAD_ITERATOR;
+
+	if (!*it)
+		return LIST_NO_ERR;
+
+	list_iterator_t next = lst->nexts[*it];
+	list_iterator_t prev = lst->prevs[*it];
+
+	lst->nexts[prev] = next;
+	lst->prevs[next] = prev;
+
+	list_mark_dirty(lst, prev);
+	list_mark_dirty(lst, next);
+	list_mark_dirty(lst, *it);
+
+	lst->nexts[*it] = lst->first_free;
+	lst->prevs[*it] = *it;
+	lst->first_free = *it;
+
+	if (*it == lst->head)
+		lst->head = next;
+
+	if (*it == lst->tail)
+		lst->tail = prev;
+	else
+		lst->normalized = false;
+
+	--lst->size;
+	LIST_EVENT(LIST_EVENT_ERASE, *it, 0);
+
+	*it = (next) ? next : prev;
+	return LIST_NO_ERR;
+}
+
+
+list_error_t list_erase_by_value (list_t lst, const void* val)
+{
+	assert (lst);
+	assert (val);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	list_iterator_t it = list_find(lst, val);
+	return list_erase(lst, &it);
+
+}
+
+
+list_error_t list_erase_by_index (list_t lst, size_t index)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	list_iterator_t it = list_element_at(lst, index);
+	return list_erase(lst, &it);
+}
+
+
+list_iterator_t list_find (const list_t lst, const void* value)
+{
+	assert (lst);
+	assert (value);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	const char* data = (const char*) lst->data;
+
+	// Loops with constant size compare elements without memcmp() calls.
+#define LIST_FIND_SIZED(SIZE_)                                                \
+	case SIZE_:                                                               \
+		for (list_iterator_t it = lst->head; it; it = lst->nexts[it])         \
+			if (!memcmp(data + it * (SIZE_), value, (SIZE_)))                 \
+				return it;                                                    \
+		return 0;
+
+	switch (lst->elem_size)
+	{
+		LIST_FIND_SIZED(1)
+		LIST_FIND_SIZED(2)
+		LIST_FIND_SIZED(4)
+		LIST_FIND_SIZED(8)
+		LIST_FIND_SIZED(16)
+		default:
+			break;
+	}
+
+#undef LIST_FIND_SIZED
+
+	for (list_iterator_t it = lst->head; it; it = lst->nexts[it])
+	{
+		if (!memcmp(data + it * lst->elem_size, value, lst->elem_size))
+			return it;
+	}
+	
+	return 0;
+}
+
+
+list_iterator_t list_element_at (const list_t lst, size_t index)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (++index >= lst->size)
+		return LIST_BAD_INDEX;
+
+	if (lst->normalized)
+		return index;
+
+	list_iterator_t it = list_head(lst);
+	for (size_t i = 1; i < index; ++i)
+		it = list_next(lst, it);
+
+	return it;
+}
+
+
+list_error_t list_clear (list_t lst)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+	
+#ifdef LIST_EVENTS
+	// Links are reset before observer is called, so erased elements
+	// are collected beforehand.
+	size_t           erased_amount = (LIST_OBSERVED()) ? lst->size - 1 : 0;
+	list_iterator_t* erased        = NULL;
+	if (erased_amount)
+	{
+		erased = (list_iterator_t*) malloc(erased_amount * sizeof *erased);
+		if (!erased)
+			return LIST_ALLOC_ERR;
+
+		size_t i = 0;
+		for (list_iterator_t it = lst->head; it; it = lst->nexts[it])
+			erased[i++] = it;
+	}
+#endif // defined LIST_EVENTS
+
+	lst->normalized = true;
+	lst->size       = 1;
+	lst->head       = 0;
+	lst->tail       = 0;
+	lst->first_free = (lst->capacity > 1) ? 1 : 0;
+	lst->nexts[0]   = 0;
+	lst->prevs[0]   = 0;
+	for (size_t i = 1; i < lst->capacity; ++i)
+	{
+		lst->nexts[i] = (i + 1) % lst->capacity;
+		lst->prevs[i] = i;
+	}
+
+#ifdef LIST_EVENTS
+	LIST_EVENT_BATCH_BEGIN();
+	for (size_t i = 0; i < erased_amount; ++i)
+		LIST_EVENT_BATCH_PUSH(LIST_EVENT_ERASE, erased[i], 0);
+	LIST_EVENT_BATCH_END();
+
+	free(erased);
+#endif // defined LIST_EVENTS
+
+	return list_change_capacity(lst, 0);
+}
+
+
+bool list_check_iterator (const list_t lst, const list_iterator_t it)
+{
+	return !it || (it < lst->capacity && lst->prevs[it] != it);
+}
+
+
+bool list_iterator_on_element (const list_iterator_t it)
+{
+	return it;
+}
+
+
+void list_print (const list_t lst, FILE* stream)
+{
+	assert (lst);
+	assert (stream);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (!lst->print_elem_func && lst->elem_size * 2 + 1 <= LIST_PRINT_BUFFER)
+	{
+		list_print_batch(lst, stream, list_format_bytes);
+		return;
+	}
+
+	fprintf(stream, "[ ");
+	for (list_iterator_t it = lst->head; it; it = lst->nexts[it])
+	{
+		const void* elem = (char*) lst->data + it * lst->elem_size;
+		if (lst->print_elem_func)
+			lst->print_elem_func(elem, stream);
+		else
+			list_print_bytes(elem, lst->elem_size, stream);
+		fputc(' ', stream);
+	}
+	fputc(']', stream);
+}
+
+
+list_error_t list_print_batch (const list_t lst, FILE* stream,
+                               list_format_func_t format)
+{
+	assert (lst);
+	assert (stream);
+	assert (format);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	char   buffer[LIST_PRINT_BUFFER];
+	size_t used = 0;
+
+	buffer[used++] = '[';
+	buffer[used++] = ' ';
+
+	list_iterator_t it = lst->head;
+	while (it)
+	{
+		list_iterator_t first  = it;
+		size_t          amount = 1;
+		while (lst->nexts[it] == it + 1)
+		{
+			++it;
+			++amount;
+		}
+		it = lst->nexts[it];
+
+		const char* elems = (char*) lst->data + first * lst->elem_size;
+		while (amount)
+		{
+			size_t written   = 0;
+			size_t formatted = format(elems, amount, lst->elem_size,
+			                          buffer + used, sizeof buffer - used,
+			                          &written);
+			used += written;
 
-	if (new_capacity > lst->capacity)
-	{
-		lst->first_free = (lst->first_free) ? lst->first_free : lst->size;
+			if (!formatted)
+			{
+				if (!used)
+					return LIST_BAD_FORMAT;
 
-		list_iterator_t free = lst->first_free;
-		for (list_iterator_t next = lst->nexts[free]; next; next = lst->nexts[free])
-			free = next;
+				if (fwrite(buffer, 1, used, stream) != used)
+					return LIST_IO_ERR;
+				used = 0;
+				continue;
+			}
 
-		new_nexts[free] = lst->size;
-		for (size_t i = lst->size; i < new_capacity; ++i)
-		{
-			new_nexts[i] = (i + 1) % new_capacity;
-			new_prevs[i] = i;
+			elems  += formatted * lst->elem_size;
+			amount -= formatted;
 		}
 	}
 
-	free(lst->data);
-	free(lst->nexts);
-	free(lst->prevs);
+	if (used == sizeof buffer)
+	{
+		if (fwrite(buffer, 1, used, stream) != used)
+			return LIST_IO_ERR;
+		used = 0;
+	}
+	buffer[used++] = ']';
 
-	lst->data     = new_data;
-	lst->nexts    = new_nexts;
-	lst->prevs    = new_prevs;
-	lst->capacity = new_capacity;
+	if (fwrite(buffer, 1, used, stream) != used)
+		return LIST_IO_ERR;
 
 	return LIST_NO_ERR;
 }
 
 
-list_iterator_t list_head (const list_t lst)
+size_t list_format_bytes (const void* elems, size_t amount, size_t elem_size,
+                          char* buffer, size_t buffer_size, size_t* written)
 {
-	assert (lst);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	assert (elems);
+	assert (buffer);
+	assert (written);
 
-	return lst->head;
+	static const char DIGITS[] = "0123456789abcdef";
+
+	const unsigned char* bytes = (const unsigned char*) elems;
+	size_t               used  = 0;
+	size_t               i     = 0;
+	for (; i < amount && used + elem_size * 2 + 1 <= buffer_size; ++i)
+	{
+		for (size_t j = 0; j < elem_size; ++j, ++bytes)
+		{
+			if (*bytes >> 4)
+				buffer[used++] = DIGITS[*bytes >> 4];
+			buffer[used++] = DIGITS[*bytes & 0xf];
+		}
+		buffer[used++] = ' ';
+	}
+
+	*written = used;
+	return i;
 }
 
 
-list_iterator_t list_tail (const list_t lst)
+#define LIST_FORMAT_NUMBERS(TYPE_, CONVERT_)                                   \
+	assert (elems);                                                           \
+	assert (buffer);                                                          \
+	assert (written);                                                         \
+	assert (elem_size == sizeof (TYPE_));                                     \
+	(void) elem_size;                                                         \
+	                                                                          \
+	const TYPE_* vals = (const TYPE_*) elems;                                 \
+	size_t       used = 0;                                                    \
+	size_t       i    = 0;                                                    \
+	for (; i < amount && used + LIST_NUMBER_MAX + 1 <= buffer_size; ++i)      \
+	{                                                                         \
+		used += CONVERT_(vals[i], buffer + used);                             \
+		buffer[used++] = ' ';                                                 \
+	}                                                                         \
+	                                                                          \
+	*written = used;                                                          \
+	return i
+
+size_t list_format_int (const void* elems, size_t amount, size_t elem_size,
+                        char* buffer, size_t buffer_size, size_t* written)
 {
-	assert (lst);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	LIST_FORMAT_NUMBERS(int, list_format_signed);
+}
 
-	return lst->tail;
+
+size_t list_format_long (const void* elems, size_t amount, size_t elem_size,
+                         char* buffer, size_t buffer_size, size_t* written)
+{
+	LIST_FORMAT_NUMBERS(long, list_format_signed);
 }
 
 
-list_error_t list_erase (list_t lst, list_iterator_t* it)
+size_t list_format_size (const void* elems, size_t amount, size_t elem_size,
+                         char* buffer, size_t buffer_size, size_t* written)
 {
-	assert (lst);
-	assert (it);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	LIST_FORMAT_NUMBERS(size_t, list_format_unsigned);
+}
 
-	if (!list_check_iterator(lst, *it))
-		return LIST_BAD_ITERATOR;
 
-	if (!*it)
-		return LIST_NO_ERR;
+/*!
+ * @brief Convert double number to text.
+ *
+ * @return Amount of written characters.
+ */
+static size_t list_format_real
+(
+	double val, /*!< [in]  number.                                           */
+	char*  out  /*!< [out] at least LIST_NUMBER_MAX characters.              */
+)
+{
+	int len = snprintf(out, LIST_NUMBER_MAX, "%g", val);
+	return (len > 0 && (size_t) len < LIST_NUMBER_MAX) ? (size_t) len : 0;
+}
 
-	list_iterator_t next = lst->nexts[*it];
-	list_iterator_t prev = lst->prevs[*it];
 
-	lst->nexts[prev] = next;
-	lst->prevs[next] = prev;
-	
-	lst->nexts[*it] = lst->first_free;
-	lst->prevs[*it] = *it;
-	lst->first_free = *it;
+size_t list_format_double (const void* elems, size_t amount, size_t elem_size,
+                           char* buffer, size_t buffer_size, size_t* written)
+{
+	LIST_FORMAT_NUMBERS(double, list_format_real);
+}
 
-	if (*it == lst->head)
-		lst->head = next;
+#undef LIST_FORMAT_NUMBERS
 
-	if (*it == lst->tail)
-		lst->tail = prev;
-	else
-		lst->normalized = false;
 
-	--lst->size;
-	*it = (next) ? next : prev;
-	return LIST_NO_ERR;
+void list_dump_func_ (const list_t lst, const char* lst_name, size_t line,
+                      const char* func_name, const char* file_name)
+{
+	list_dump_opts_t opts = {0};
+	list_dump_ex_func_(lst, &opts, lst_name, line, func_name, file_name);
 }
 
 
-list_error_t list_erase_by_value (list_t lst, const void* val)
+void list_dump_ex_func_ (const list_t lst, const list_dump_opts_t* opts,
+                         const char* lst_name, size_t line,
+                         const char* func_name, const char* file_name)
 {
 	assert (lst);
-	assert (val);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	assert (opts);
+	assert (lst_name);
+	assert (func_name);
+	assert (file_name);
 
-	list_iterator_t it = list_find(lst, val);
-	return list_erase(lst, &it);
+	char dump_fname[LIST_MAX_FNAME] = {0};
+	sprintf(dump_fname, "%s_%zd_%s_%s.dot",
+	        lst_name, line, func_name, file_name);
+
+	FILE* dump = fopen(dump_fname, "w");
+	if (!dump)
+	{
+		perror("List dump failed");
+		return;
+	}
+
+	size_t buffer_size = (opts->buffer_size) ? opts->buffer_size
+	                                         : LIST_DUMP_BUFFER;
+	char*  buffer      = (char*) malloc(buffer_size);
+	if (buffer)
+		setvbuf(dump, buffer, _IOFBF, buffer_size);
+
+	unsigned char* shown = list_dump_select(lst, opts);
+
+	list_write_dump_to_dot(lst, dump, shown,
+	                       lst_name, line, func_name, file_name);
+	fclose(dump);
+	free(buffer);
+	free(shown);
+
+	if (opts->render == LIST_DUMP_RENDER_NONE)
+		return;
+
+	char command[LIST_MAX_FNAME * 2] = {0};
+	sprintf(command, "dot %s_%zd_%s_%s.dot -Tpng -o %s_%zd_%s_%s.png%s",
+	        lst_name, line, func_name, file_name,
+	        lst_name, line, func_name, file_name,
+	        (opts->render == LIST_DUMP_RENDER_ASYNC) ? " &" : "");
 
+	system(command);
 }
 
 
-list_error_t list_erase_by_index (list_t lst, size_t index)
+list_error_t list_dump_json (const list_t lst, FILE* stream)
 {
 	assert (lst);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	assert (stream);
 
-	list_iterator_t it = list_element_at(lst, index);
-	return list_erase(lst, &it);
+	fprintf(stream, "{\"elem_size\":%zu,\"size\":%zu,\"capacity\":%zu,"
+	                "\"first_free\":%zu,\"head\":%zu,\"tail\":%zu,"
+	                "\"normalized\":%s,\n\"nexts\":[",
+	        lst->elem_size, lst->size, lst->capacity, lst->first_free,
+	        lst->head, lst->tail, (lst->normalized) ? "true" : "false");
+	list_write_indexes(lst->nexts, lst->capacity, stream);
+
+	fputs("],\n\"prevs\":[", stream);
+	list_write_indexes(lst->prevs, lst->capacity, stream);
+
+	fputs("],\n\"data\":\"", stream);
+	list_write_hex(lst->data, lst->capacity * lst->elem_size, stream);
+	fputs("\"}\n", stream);
+
+	return (ferror(stream)) ? LIST_IO_ERR : LIST_NO_ERR;
 }
 
 
-list_iterator_t list_find (const list_t lst, const void* value)
+list_error_t list_dump_binary (const list_t lst, FILE* stream)
 {
 	assert (lst);
-	assert (value);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	assert (stream);
 
-	for (list_iterator_t it = lst->head; it; it = lst->nexts[it])
-	{
-		if (!memcmp((char*) lst->data + it * lst->elem_size, value,
-		           lst->elem_size))
-		{
-			return it;
-		}
-	}
-	
-	return 0;
+	list_state_header_t header;
+	list_fill_state_header(lst, &header, LIST_STATE_MAGIC);
+
+	if (fwrite(&header, sizeof header, 1, stream) != 1
+	    || fwrite(lst->data, lst->elem_size, lst->capacity, stream)
+	       != lst->capacity
+	    || fwrite(lst->nexts, sizeof *lst->nexts, lst->capacity, stream)
+	       != lst->capacity
+	    || fwrite(lst->prevs, sizeof *lst->prevs, lst->capacity, stream)
+	       != lst->capacity)
+		return LIST_IO_ERR;
+
+	return LIST_NO_ERR;
 }
 
 
-list_iterator_t list_element_at (const list_t lst, size_t index)
+list_t list_load_binary_dump (FILE* stream,
+                              void (*print_func) (const void*, FILE*))
 {
-	assert (lst);
-	assert (list_verify(lst) == LIST_NO_ERR);
+	assert (stream);
 
-	if (++index >= lst->size)
-		return LIST_BAD_INDEX;
+	list_state_header_t header;
+	if (fread(&header, sizeof header, 1, stream) != 1
+	    || !list_check_state_header(&header, LIST_STATE_MAGIC))
+		return NULL;
 
-	if (lst->normalized)
-		return index;
+	list_t lst = list_create_func_((size_t) header.capacity - 1, print_func,
+	                               (size_t) header.elem_size);
+	if (!lst)
+		return NULL;
 
-	list_iterator_t it = list_head(lst);
-	for (size_t i = 1; i < index; ++i)
-		it = list_next(lst, it);
+	if (fread(lst->data, lst->elem_size, lst->capacity, stream)
+	    != lst->capacity
+	    || fread(lst->nexts, sizeof *lst->nexts, lst->capacity, stream)
+	       != lst->capacity
+	    || fread(lst->prevs, sizeof *lst->prevs, lst->capacity, stream)
+	       != lst->capacity)
+		return list_destroy(lst);
 
-	return it;
+	lst->size       = (size_t) header.size;
+	lst->first_free = (size_t) header.first_free;
+	lst->head       = (size_t) header.head;
+	lst->tail       = (size_t) header.tail;
+	lst->normalized = header.normalized;
+
+	return lst;
 }
 
 
-list_error_t list_clear (list_t lst)
+list_error_t list_delta_enable (list_t lst)
 {
 	assert (lst);
-	assert (list_verify(lst) == LIST_NO_ERR);
-	
-	lst->normalized  = true;
-	lst->size        = 1;
-	list_error_t err = list_change_capacity(lst, 0);
-	if (err != LIST_NO_ERR)
-		return err;
 
-	lst->nexts[0] = 0;
-	lst->prevs[0] = 0;
+	if (!lst->dirty)
+	{
+		lst->dirty = (unsigned char*) malloc(list_dirty_size(lst->capacity));
+		if (!lst->dirty)
+			return LIST_ALLOC_ERR;
+	}
 
+	list_mark_all_dirty(lst);
 	return LIST_NO_ERR;
 }
 
 
-bool list_check_iterator (const list_t lst, const list_iterator_t it)
+void list_delta_disable (list_t lst)
 {
-	return !it || (it < lst->capacity && lst->prevs[it] != it);
+	assert (lst);
+
+	free(lst->dirty);
+	lst->dirty = NULL;
 }
 
 
-bool list_iterator_on_element (const list_iterator_t it)
+void list_delta_touch (list_t lst, const list_iterator_t it)
 {
-	return it;
+	assert (lst);
+
+	if (it < lst->capacity)
+		list_mark_dirty(lst, it);
 }
 
 
-void list_print (const list_t lst, FILE* stream)
+list_error_t list_dump_delta (list_t lst, FILE* stream)
 {
 	assert (lst);
 	assert (stream);
-	assert (list_verify(lst) == LIST_NO_ERR);
 
-	fprintf(stream, "[ ");
-	for (list_iterator_t it = list_head(lst); it; it = list_next(lst, it))
+	if (!lst->dirty)
+		return LIST_BAD_MEMORY;
+
+	list_delta_header_t header;
+	list_fill_state_header(lst, &header.state, LIST_DELTA_MAGIC);
+
+	header.amount = 0;
+	for (size_t i = 0; i < lst->capacity; ++i)
+		header.amount += lst->dirty[i / 8] >> (i % 8) & 1;
+
+	if (fwrite(&header, sizeof header, 1, stream) != 1)
+		return LIST_IO_ERR;
+
+	for (size_t i = 0; i < lst->capacity; ++i)
 	{
-		if (lst->print_elem_func)
-			lst->print_elem_func(list_get(lst, it), stream);
-		else
-			list_print_bytes(list_get(lst, it), lst->elem_size, stream);
-		fputc(' ', stream);
+		if (!(lst->dirty[i / 8] >> (i % 8) & 1))
+			continue;
+
+		if (fwrite(&i, sizeof i, 1, stream) != 1
+		    || fwrite(&lst->nexts[i], sizeof *lst->nexts, 1, stream) != 1
+		    || fwrite(&lst->prevs[i], sizeof *lst->prevs, 1, stream) != 1
+		    || fwrite((char*) lst->data + i * lst->elem_size,
+		              lst->elem_size, 1, stream) != 1)
+			return LIST_IO_ERR;
 	}
-	fputc(']', stream);
+
+	memset(lst->dirty, 0, list_dirty_size(lst->capacity));
+	return LIST_NO_ERR;
 }
 
 
-void list_dump_func_ (const list_t lst, const char* lst_name, size_t line,
-                      const char* func_name, const char* file_name)
+list_error_t list_apply_delta (list_t lst, FILE* stream)
 {
-	assert (lst_name);
-	assert (func_name);
-	assert (file_name);
+	assert (lst);
+	assert (stream);
 
-	char dump_fname[LIST_MAX_FNAME] = {0};
-	sprintf(dump_fname, "%s_%zd_%s_%s.dot",
-	        lst_name, line, func_name, file_name);
+	list_delta_header_t header;
+	if (fread(&header, sizeof header, 1, stream) != 1)
+		return LIST_IO_ERR;
 
-	FILE* dump = fopen(dump_fname, "w");
-	if (!dump)
+	if (!list_check_state_header(&header.state, LIST_DELTA_MAGIC)
+	    || header.state.elem_size != lst->elem_size)
+		return LIST_BAD_FORMAT;
+
+	list_error_t err = list_resize_slots(lst,
+	                                     (size_t) header.state.capacity - 1);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	for (uint64_t rec = 0; rec < header.amount; ++rec)
 	{
-		perror("List dump failed");
-		return;
+		size_t i = 0;
+		if (fread(&i, sizeof i, 1, stream) != 1)
+			return LIST_IO_ERR;
+
+		if (i >= lst->capacity)
+			return LIST_BAD_FORMAT;
+
+		if (fread(&lst->nexts[i], sizeof *lst->nexts, 1, stream) != 1
+		    || fread(&lst->prevs[i], sizeof *lst->prevs, 1, stream) != 1
+		    || fread((char*) lst->data + i * lst->elem_size,
+		             lst->elem_size, 1, stream) != 1)
+			return LIST_IO_ERR;
+
+		list_mark_dirty(lst, i);
 	}
-	
-	list_write_dump_to_dot(lst, dump, lst_name, line, func_name, file_name);
-	fclose(dump);
 
-	char command[LIST_MAX_FNAME * 2] = {0};
-	sprintf(command, "dot %s_%zd_%s_%s.dot -Tpng -o %s_%zd_%s_%s.png",
-	        lst_name, line, func_name, file_name,
-	        lst_name, line, func_name, file_name);
+	lst->size       = (size_t) header.state.size;
+	lst->first_free = (size_t) header.state.first_free;
+	lst->head       = (size_t) header.state.head;
+	lst->tail       = (size_t) header.state.tail;
+	lst->normalized = header.state.normalized;
 
-	system(command);
+	return LIST_NO_ERR;
 }
 
 
@@ -669,29 +1949,27 @@ void list_normalize (list_t lst)
 		return;
 	}
 
+	// Observer needs moves of elements which only in place pass reports.
+	if (lst->storage && lst->storage->normalize && !LIST_OBSERVED()
+	    && lst->storage->normalize(lst) == LIST_NO_ERR)
+	{
+		list_mark_all_dirty(lst);
+		return;
+	}
+
+	LIST_EVENT_BATCH_BEGIN();
+
 	lst->normalized    = true;
 	list_iterator_t it = lst->head;
 	for (size_t i = 1; i < lst->size; ++i)
 	{
-		if (i == it)
+		if (it != i)
 		{
-			it = lst->nexts[it];
-			lst->nexts[i] = (i + 1) % lst->size;
-			lst->prevs[i] = i - 1;
-			continue;
+			list_swap_slots(lst, i, it);
+			LIST_EVENT_BATCH_PUSH(LIST_EVENT_MOVE, it, i);
 		}
 
-		list_iterator_t tmp_it    = lst->nexts[it];
-		lst->nexts[it]            = lst->nexts[i];
-		list_swap_vals(lst, i, it);
-
-		size_t* tmp = &lst->nexts[lst->prevs[i]];
-		*tmp        = (*tmp > i) ? it : *tmp;
-
-		lst->prevs[i] = i - 1;
-		lst->nexts[i] = (i + 1) % lst->size;
-		
-		it = tmp_it;
+		it = lst->nexts[i];
 	}
 
 	lst->head       = 1;
@@ -706,6 +1984,9 @@ void list_normalize (list_t lst)
 		lst->nexts[i] = (i + 1) % lst->capacity;
 		lst->prevs[i] = i;
 	}
+
+	list_mark_all_dirty(lst);
+	LIST_EVENT_BATCH_END();
 }
 
 
@@ -744,6 +2025,9 @@ void list_perror (list_error_t err, FILE* stream)
 
 		case LIST_BAD_FREE_FIELDS: LIST_PERROR_CASE("bad some free fields");
 		case LIST_BAD_BUSY_FIELDS: LIST_PERROR_CASE("bad some busy fields");
+
+		case LIST_IO_ERR:     LIST_PERROR_CASE("input/output error");
+		case LIST_BAD_FORMAT: LIST_PERROR_CASE("bad format of input data");
 		default:                   LIST_PERROR_CASE("unknown error");
 	}
 }
@@ -761,3 +2045,117 @@ size_t list_capacity (const list_t lst)
 {
 	return lst->capacity - 1;
 }
+
+
+void list_set_relocate (list_t lst, void (*relocate) (void*, void*, size_t))
+{
+	assert (lst);
+
+	lst->relocate = relocate;
+}
+
+
+#ifdef LIST_EVENTS
+
+void list_set_observer (list_t lst, list_observer_t observer, void* ctx)
+{
+	assert (lst);
+
+	lst->observer     = observer;
+	lst->observer_ctx = ctx;
+}
+
+#endif // defined LIST_EVENTS
+
+
+void list_memory_usage (const list_t lst, list_memory_usage_t* usage)
+{
+	assert (lst);
+	assert (usage);
+
+	size_t slot = lst->elem_size + sizeof *lst->nexts + sizeof *lst->prevs;
+
+	usage->header = sizeof *lst;
+	usage->data   = lst->capacity * lst->elem_size;
+	usage->nexts  = lst->capacity * sizeof *lst->nexts;
+	usage->prevs  = lst->capacity * sizeof *lst->prevs;
+	usage->aux    = ((lst->dirty)  ? list_dirty_size(lst->capacity)   : 0)
+	                + ((lst->chunks) ? LIST_CHUNKS_SIZE(lst->capacity) : 0);
+	usage->total  = usage->header + usage->data + usage->nexts + usage->prevs
+	                + usage->aux;
+	usage->live   = (lst->size - 1) * slot;
+	usage->free   = (lst->capacity - lst->size) * slot;
+}
+
+
+void list_registry_set_tag (const list_t lst, const char* tag)
+{
+	assert (lst);
+
+#ifdef LIST_REGISTRY
+	list_registry_entry_t* entry = list_registry_find(lst);
+	if (entry)
+		entry->tag = tag;
+#else
+	(void) tag;
+#endif // defined LIST_REGISTRY
+}
+
+
+void list_registry_report (FILE* stream)
+{
+	assert (stream);
+
+#ifdef LIST_REGISTRY
+	list_registry_entry_t* entries = (list_registry_entry_t*)
+		malloc((list_registry_size + 1) * sizeof *entries);
+	if (!entries)
+	{
+		list_perror(LIST_ALLOC_ERR, stream);
+		return;
+	}
+
+	if (list_registry_size)
+		memcpy(entries, list_registry, list_registry_size * sizeof *entries);
+	qsort(entries, list_registry_size, sizeof *entries, list_registry_cmp);
+
+	fprintf(stream, "  %-24s %10s %12s %12s %14s %14s %14s\n",
+	        "tag", "elem size", "size", "capacity",
+	        "data bytes", "links bytes", "wasted bytes");
+
+	size_t total_data   = 0;
+	size_t total_links  = 0;
+	size_t total_wasted = 0;
+	for (size_t i = 0; i < list_registry_size; ++i)
+	{
+		const list_t lst = entries[i].lst;
+
+		list_memory_usage_t usage;
+		list_memory_usage(lst, &usage);
+
+		size_t data   = usage.data;
+		size_t links  = usage.nexts + usage.prevs;
+		size_t wasted = usage.free;
+
+		fprintf(stream, "%c %-24s %10zu %12zu %12zu %14zu %14zu %14zu\n",
+		        (wasted * 2 > data + links) ? '!' : ' ',
+		        (entries[i].tag) ? entries[i].tag : "(untagged)",
+		        lst->elem_size, list_size(lst), list_capacity(lst),
+		        data, links, wasted);
+
+		total_data   += data;
+		total_links  += links;
+		total_wasted += wasted;
+	}
+
+	fprintf(stream, "  %-24s %10s %12s %12s %14zu %14zu %14zu\n"
+	                "  %zu live lists\n",
+	        "total", "", "", "", total_data, total_links, total_wasted,
+	        list_registry_size);
+
+	free(entries);
+#else
+	fputs("list registry is disabled, "
+	      "compile list.c with LIST_REGISTRY macro defined\n", stream);
+#endif // defined LIST_REGISTRY
+}
@@ -18,6 +18,26 @@
  */
 #define LIST_MAX_FNAME ((size_t) 8192)
 
+/*!
+ * @brief Default size of the buffer of dump file.
+ */
+#define LIST_DUMP_BUFFER ((size_t) 1 << 20)
+
+/*!
+ * @brief Size of the buffer which is used by list_print_batch().
+ */
+#define LIST_PRINT_BUFFER ((size_t) 16384)
+
+/*!
+ * @brief Amount of slots in one chunk of incremental checkpoint.
+ */
+#define LIST_CHUNK_SLOTS ((size_t) 4096)
+
+/*!
+ * @brief Size of bitmap of changed chunks of the list.
+ */
+#define LIST_CHUNKS_SIZE(CAPACITY_) ((CAPACITY_) / LIST_CHUNK_SLOTS / 8 + 1)
+
 /*!
  * @brief Coefficient that shows how many times will the value
  * of list capacity change.
@@ -27,11 +47,49 @@
 
 
 
+/*!
+ * @brief Max amount of events which are passed to list observer at once.
+ */
+#define LIST_EVENTS_BATCH ((size_t) 128)
+
+
+
+
 /*!
  * @brief Iterator of list elements.
  */
 typedef size_t list_iterator_t;
 
+struct list_storage_t_;
+
+#ifdef LIST_EVENTS
+
+/*!
+ * @brief Types of list mutation events.
+ */
+typedef enum
+{
+	LIST_EVENT_INSERT = 0, /*!< element "to" was inserted after "from".      */
+	LIST_EVENT_ERASE  = 1, /*!< element "from" was erased.                   */
+	LIST_EVENT_MOVE   = 2, /*!< contents of slots "from" and "to" were
+	                            exchanged. One of them can be free.          */
+	LIST_EVENT_RESIZE = 3, /*!< capacity was changed from "from" to "to".    */
+}
+list_event_type_t;
+
+/*!
+ * @brief List mutation event.
+ */
+typedef struct
+{
+	list_event_type_t type; /*!< type of event.                              */
+	size_t            from; /*!< first argument of event.                    */
+	size_t            to;   /*!< second argument of event.                   */
+}
+list_event_t;
+
+#endif // defined LIST_EVENTS
+
 /*!
  * @brief Double linked list structure.
  */
@@ -53,9 +111,120 @@ typedef struct list_t_
 
 	void (*print_elem_func) (const void*, FILE*); /*!< function which prints
 	                                                   one list element.     */
+	void (*relocate) (void*, void*, size_t);      /*!< function which moves
+	                                                   elements between heap
+	                                                   slots or NULL to use
+	                                                   memcpy().             */
+
+	unsigned char*  dirty;      /*!< bitmap of slots changed since
+	                                 the last delta dump or NULL if
+	                                 delta dumps are disabled.               */
+	unsigned char*  chunks;     /*!< bitmap of chunks of LIST_CHUNK_SLOTS
+	                                 slots changed since the last
+	                                 incremental checkpoint or NULL if
+	                                 it hasn't been made.                    */
+
+	const struct list_storage_t_* storage; /*!< storage of arrays or NULL
+	                                            if they are allocated
+	                                            in heap.                     */
+	void*           storage_ctx; /*!< context of storage.                    */
+
+#ifdef LIST_EVENTS
+	void (*observer) (struct list_t_*, const list_event_t*, size_t, void*);
+	                            /*!< function which receives
+	                                 mutation events.                        */
+	void*           observer_ctx; /*!< context passed to observer.           */
+#endif // defined LIST_EVENTS
 }
 *list_t;
 
+#ifdef LIST_EVENTS
+
+/*!
+ * @brief Function which receives list mutation events.
+ *
+ * It is called after mutation has been performed. Bulk operations
+ * (list_normalize, list_change_capacity, list_clear) pass up to
+ * LIST_EVENTS_BATCH events at once. Erase events of list_clear() are
+ * passed when the list is already empty.
+ */
+typedef void (*list_observer_t)
+(
+	list_t              lst,    /*!< [in] list.                              */
+	const list_event_t* events, /*!< [in] array of events.                   */
+	size_t              amount, /*!< [in] amount of events.                  */
+	void*               ctx     /*!< [in] context of observer.               */
+);
+
+#endif // defined LIST_EVENTS
+
+/*!
+ * @brief Function which formats a span of consecutive list elements.
+ *
+ * Every element is formatted with a space after it.
+ *
+ * @return Amount of elements which have been formatted. It formats
+ * as many elements as fit into the buffer.
+ */
+typedef size_t (*list_format_func_t)
+(
+	const void* elems,       /*!< [in]  first element of the span.           */
+	size_t      amount,      /*!< [in]  amount of elements in the span.      */
+	size_t      elem_size,   /*!< [in]  size of one element.                 */
+	char*       buffer,      /*!< [out] buffer for text.                     */
+	size_t      buffer_size, /*!< [in]  size of the buffer.                  */
+	size_t*     written      /*!< [out] amount of written bytes.             */
+);
+
+/*!
+ * @brief Memory used by a list in bytes.
+ */
+typedef struct
+{
+	size_t header; /*!< list structure.                                      */
+	size_t data;   /*!< array with data.                                     */
+	size_t nexts;  /*!< array with indexes of next elements.                 */
+	size_t prevs;  /*!< array with indexes of previous elements.             */
+	size_t aux;    /*!< auxiliary structures.                                */
+	size_t total;  /*!< all allocated memory.                                */
+	size_t live;   /*!< data and links of elements in the list.              */
+	size_t free;   /*!< data and links of free elements.                     */
+}
+list_memory_usage_t;
+
+/*!
+ * @brief Ways to render .png picture from .dot dump.
+ */
+typedef enum
+{
+	LIST_DUMP_RENDER_SYNC  = 0, /*!< run GraphViz and wait for it.           */
+	LIST_DUMP_RENDER_NONE  = 1, /*!< write only .dot file.                   */
+	LIST_DUMP_RENDER_ASYNC = 2, /*!< run GraphViz in background.             */
+}
+list_dump_render_t;
+
+/*!
+ * @brief Options of list dump.
+ *
+ * Zero initialized options make the same dump as list_dump().
+ */
+typedef struct
+{
+	size_t             buffer_size; /*!< size of the buffer of dump file.
+	                                     If it equals to 0
+	                                     LIST_DUMP_BUFFER is used.           */
+	list_dump_render_t render;      /*!< way to render picture.              */
+	list_iterator_t    center;      /*!< element around which slots
+	                                     are dumped if window isn't 0.       */
+	size_t             window;      /*!< amount of elements before and after
+	                                     center element in the list order
+	                                     which will be dumped. If it equals
+	                                     to 0 window isn't used.             */
+	size_t             sample_step; /*!< if it is greater than 1 every
+	                                     sample_step-th slot is dumped.      */
+}
+list_dump_opts_t;
+
 /*!
  * @brief Enum with possible list's errors.
  */
@@ -74,9 +243,30 @@ typedef enum
 	LIST_BAD_TAIL_ITERATOR   = 10,
 	LIST_BAD_FREE_FIELDS     = 11,
 	LIST_BAD_BUSY_FIELDS     = 12,
+	LIST_IO_ERR              = 13,
+	LIST_BAD_FORMAT          = 14,
 }
 list_error_t;
 
+/*!
+ * @brief Storage of data, nexts and prevs arrays which are placed
+ * not in heap.
+ */
+typedef struct list_storage_t_
+{
+	list_error_t (*resize) (list_t, size_t); /*!< change size of arrays to new
+	                                              capacity keeping the first
+	                                              slots. It mustn't change
+	                                              capacity field.            */
+	void (*release) (list_t);                /*!< release arrays and context
+	                                              of storage.                */
+	list_error_t (*normalize) (list_t);      /*!< normalize the list or NULL.
+	                                              On failure the list must
+	                                              stay unchanged and it is
+	                                              normalized in place.       */
+}
+list_storage_t;
+
 
 
 
@@ -145,6 +335,46 @@ list_error_t list_insert_after
 	const void*           value /*!< [in]     value which will be inserted.  */
 );
 
+/*!
+ * @brief Link new element after current element without initializing it.
+ *
+ * Value of the element must be written through list_get() pointer.
+ * It is used to construct elements in place. Insert event isn't passed
+ * to observer until list_emplace_commit() is called after the element
+ * has been written.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_emplace_after
+(
+	list_t                lst,  /*!< [in,out] list.                          */
+	const list_iterator_t it,   /*!< [in]     iterator to current element.   */
+	list_iterator_t*      place /*!< [out]    iterator to new element.       */
+);
+
+/*!
+ * @brief Pass insert event of element linked by list_emplace_after()
+ * to observer. Call it after the element has been written.
+ */
+void list_emplace_commit
+(
+	list_t                lst,  /*!< [in,out] list.                          */
+	const list_iterator_t place /*!< [in]     iterator to new element.       */
+);
+
+/*!
+ * @brief Erase element linked by list_emplace_after() which hasn't been
+ * written, e.g. when its constructor has thrown. No events are passed
+ * to observer.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_emplace_cancel
+(
+	list_t          lst,  /*!< [in,out] list.                                */
+	list_iterator_t place /*!< [in]     iterator to new element.             */
+);
+
 /*!
  * @brief Insert an element to list before current.
  *
@@ -237,6 +467,23 @@ list_error_t list_change_capacity
 	size_t new_capacity /*!< [in]     new capacity.                          */
 );
 
+/*!
+ * @brief Change capacity of the list keeping slots as they are.
+ *
+ * Arrays are truncated or extended by zeroed slots which are marked
+ * as changed, links aren't fixed. It is used to apply deltas
+ * and checkpoints which carry links of new slots.
+ *
+ * @note State of the list isn't verified.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_resize_slots
+(
+	list_t lst,         /*!< [in,out] list.                                  */
+	size_t new_capacity /*!< [in]     new capacity.                          */
+);
+
 /*!
  * @brief Get head of the list.
  *
@@ -358,6 +605,53 @@ void list_print
 	FILE*        stream /*!< [in] stream where list will be printed.         */
 );
 
+/*!
+ * @brief Print list using batch formatter.
+ *
+ * Elements are traversed without validation of every step, formatted
+ * by spans of elements which are consecutive in memory and written
+ * through a local buffer. Output has the same format as list_print().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_print_batch
+(
+	const list_t       lst,    /*!< [in]     list.                           */
+	FILE*              stream, /*!< [in,out] stream where list will be
+	                                         printed.                        */
+	list_format_func_t format  /*!< [in]     batch formatter.                */
+);
+
+/*!
+ * @brief Batch formatter which prints elements by bytes like list_print().
+ */
+size_t list_format_bytes (const void* elems, size_t amount, size_t elem_size,
+                          char* buffer, size_t buffer_size, size_t* written);
+
+/*!
+ * @brief Batch formatter of int elements.
+ */
+size_t list_format_int (const void* elems, size_t amount, size_t elem_size,
+                        char* buffer, size_t buffer_size, size_t* written);
+
+/*!
+ * @brief Batch formatter of long elements.
+ */
+size_t list_format_long (const void* elems, size_t amount, size_t elem_size,
+                         char* buffer, size_t buffer_size, size_t* written);
+
+/*!
+ * @brief Batch formatter of size_t elements.
+ */
+size_t list_format_size (const void* elems, size_t amount, size_t elem_size,
+                         char* buffer, size_t buffer_size, size_t* written);
+
+/*!
+ * @brief Batch formatter of double elements.
+ */
+size_t list_format_double (const void* elems, size_t amount, size_t elem_size,
+                           char* buffer, size_t buffer_size, size_t* written);
+
 /*!
 * @brief Dump list to file "<list_name_line_func_file>.dot"
 * and create .png file from it using GraphVis.
@@ -379,6 +673,140 @@ void list_dump_func_
 	const char*  file_name  /*!< [in] file name where dump function was
 	                                  called.                                */
 );
+/*!
+ * @brief Dump list to file "<list_name_line_func_file>.dot" with options.
+ */
+#define list_dump_ex(LST_, OPTS_) list_dump_ex_func_((LST_), (OPTS_),           \
+	#LST_, __LINE__, __func__, __FILE__)
+
+/*!
+ * @brief Dump list to file "<list_name_line_func_file>.dot" with options.
+ *
+ * File is written through a large buffer. Only slots selected by window
+ * and sample_step options are written. It's useful for huge lists.
+ */
+void list_dump_ex_func_
+(
+	const list_t            lst,       /*!< [in] list.                       */
+	const list_dump_opts_t* opts,      /*!< [in] options of dump.            */
+	const char*             lst_name,  /*!< [in] name of the list variable.  */
+	size_t                  line,      /*!< [in] line where dump function
+	                                             was called.                 */
+	const char*             func_name, /*!< [in] function name where dump
+	                                             function was called.        */
+	const char*             file_name  /*!< [in] file name where dump
+	                                             function was called.        */
+);
+
+/*!
+ * @brief Write state of the list in JSON format.
+ *
+ * Object contains all fields of list structure, arrays "nexts" and "prevs"
+ * and "data" string with hexadecimal bytes of data array.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_dump_json
+(
+	const list_t lst,   /*!< [in]     list.                                  */
+	FILE*        stream /*!< [in,out] output stream.                         */
+);
+
+/*!
+ * @brief Write state of the list in binary format.
+ *
+ * Format is a header (magic "LSTS", version, size of index,
+ * fields of list structure) followed by raw data, nexts and prevs arrays.
+ * Byte order and size of index are the same as in the running program.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_dump_binary
+(
+	const list_t lst,   /*!< [in]     list.                                  */
+	FILE*        stream /*!< [in,out] output stream.                         */
+);
+
+/*!
+ * @brief Load list written by list_dump_binary().
+ *
+ * @note State of loaded list isn't verified. Use list_verify() before
+ * using other functions with it.
+ *
+ * @return Loaded list or NULL if some error has been occurred.
+ */
+list_t list_load_binary_dump
+(
+	FILE* stream,                           /*!< [in,out] input stream.      */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+);
+
+/*!
+ * @brief Enable tracking of changed slots for delta dumps.
+ *
+ * All slots are marked as changed so the first delta dump contains
+ * the whole list.
+ *
+ * @note Changes made through pointers returned by list_get() aren't tracked.
+ * Use list_delta_touch() after them.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_delta_enable
+(
+	list_t lst /*!< [in,out] list.                                           */
+);
+
+/*!
+ * @brief Disable tracking of changed slots for delta dumps.
+ */
+void list_delta_disable
+(
+	list_t lst /*!< [in,out] list.                                           */
+);
+
+/*!
+ * @brief Mark element as changed for the next delta dump.
+ */
+void list_delta_touch
+(
+	list_t                lst, /*!< [in,out] list.                           */
+	const list_iterator_t it   /*!< [in]     iterator of changed element.    */
+);
+
+/*!
+ * @brief Write slots changed since the previous delta dump.
+ *
+ * Format is a header (magic "LSTD", the same fields as in list_dump_binary()
+ * and amount of slots) followed by records of slots: index, next, previous
+ * and data. After writing all slots are marked as unchanged.
+ *
+ * @return Error code which has been occurred during performing this function.
+ * If tracking isn't enabled it returns LIST_BAD_MEMORY.
+ */
+list_error_t list_dump_delta
+(
+	list_t lst,   /*!< [in,out] list.                                        */
+	FILE*  stream /*!< [in,out] output stream.                               */
+);
+
+/*!
+ * @brief Apply delta written by list_dump_delta() to the list.
+ *
+ * Applying all deltas in order to an empty list with the same element size
+ * restores the state of the list at the time of the last delta.
+ *
+ * @note State of the list isn't verified.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_apply_delta
+(
+	list_t lst,   /*!< [in,out] list.                                        */
+	FILE*  stream /*!< [in,out] input stream.                                */
+);
+
 /*!
  * @brief Normilize the order of elements in list.
  *
@@ -429,6 +857,90 @@ size_t list_capacity
 	const list_t lst /*!< [in] list.                                         */
 );
 
+/*!
+ * @brief Set function which moves elements when heap list is normalized
+ * or its capacity is changed.
+ *
+ * Function moves amount elements from src to uninitialized dst, after that
+ * src is treated as uninitialized. It allows to store objects which can't
+ * be moved by memcpy(), e.g. objects with pointers to themselves.
+ * Virtual element is used as uninitialized temporary slot.
+ *
+ * @note Function isn't used by resize of lists with storage, storage moves
+ * elements itself. Functions which save or sort lists copy bytes.
+ */
+void list_set_relocate
+(
+	list_t lst,                                /*!< [in,out] list.           */
+	void (*relocate) (void*, void*, size_t)    /*!< [in]     function or NULL
+	                                                         to use memcpy().*/
+);
+
+#ifdef LIST_EVENTS
+
+/*!
+ * @brief Set observer of the list mutations.
+ *
+ * @note LIST_EVENTS macro must be defined both for list.c
+ * and for all files including list.h, otherwise events are compiled out.
+ */
+void list_set_observer
+(
+	list_t          lst,      /*!< [in,out] list.                            */
+	list_observer_t observer, /*!< [in]     observer or NULL to remove it.   */
+	void*           ctx       /*!< [in]     context passed to observer.      */
+);
+
+#endif // defined LIST_EVENTS
+
+/*!
+ * @brief Get amount of memory allocated by the list.
+ */
+void list_memory_usage
+(
+	const list_t         lst,  /*!< [in]  list.                              */
+	list_memory_usage_t* usage /*!< [out] memory usage.                      */
+);
+
+/*!
+ * @brief Set name tag of the list in the registry of lists.
+ *
+ * @note Registry works only if list.c was compiled with LIST_REGISTRY
+ * macro defined. Otherwise this function does nothing.
+ * Tag is not copied so it must live until list is destroyed.
+ */
+void list_registry_set_tag
+(
+	const list_t lst, /*!< [in] list.                                        */
+	const char*  tag  /*!< [in] name tag of the list.                        */
+);
+
+/*!
+ * @brief Print memory usage of all live lists.
+ *
+ * Lists are sorted by amount of bytes wasted by free capacity.
+ * Lists which waste more than a half of their arrays are marked by '!'.
+ *
+ * @note Registry works only if list.c was compiled with LIST_REGISTRY
+ * macro defined. It isn't thread safe.
+ */
+void list_registry_report
+(
+	FILE* stream /*!< [in,out] output stream.                                */
+);
+
+
+
+
+/*!
+ * Unity build: define LIST_IMPLEMENTATION in one C file before including
+ * this header to compile the list into that file, so list_next(), list_get()
+ * and others can be inlined into its loops. Don't link list.c then.
+ */
+#ifdef LIST_IMPLEMENTATION
+#include "list.c"
+#endif // defined LIST_IMPLEMENTATION
+
 
 
 
@@ -0,0 +1,905 @@
+/*!
+ * @brief Header file with C++ wrapper of doubly linked list.
+ */
+
+
+#ifndef LIST_HPP_
+#define LIST_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L
+#include <coroutine>
+#include <optional>
+#include <ranges>
+#include <span>
+#endif // C++20
+
+extern "C"
+{
+#include "list.h"
+}
+
+
+
+
+namespace dll
+{
+
+/*!
+ * @brief Exception which is thrown when list function fails.
+ */
+class list_error : public std::runtime_error
+{
+public:
+	explicit list_error (list_error_t code)
+		: std::runtime_error("list error " + std::to_string(code)),
+		  code_(code)
+	{}
+
+	/*!
+	 * @brief Get error code.
+	 */
+	list_error_t code () const noexcept { return code_; }
+
+private:
+	list_error_t code_; /*!< error code.                                     */
+};
+
+/*!
+ * @brief Trait which shows that objects of type T can be moved
+ * to other memory by memcpy() without calling constructors and destructors.
+ *
+ * Specialize it for types which aren't trivially copyable but don't depend
+ * on their address (e.g. most of smart pointers) to move them in bulk.
+ */
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+	is_trivially_relocatable<T>::value;
+
+namespace detail
+{
+
+/*!
+ * @brief Throw exception if error has been occurred.
+ */
+inline void check (list_error_t err)
+{
+	if (err == LIST_ALLOC_ERR)
+		throw std::bad_alloc();
+	if (err != LIST_NO_ERR)
+		throw list_error(err);
+}
+
+/*!
+ * @brief Bidirectional iterator over list elements.
+ *
+ * Virtual element (index 0) is the end of the list.
+ *
+ * @note Changes made through iterators aren't tracked by list_delta_enable()
+ * and list_checkpoint_incremental(). Use list::touch() after them.
+ */
+template <typename T, bool Const>
+class iterator
+{
+public:
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type        = T;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = std::conditional_t<Const, const T*, T*>;
+	using reference         = std::conditional_t<Const, const T&, T&>;
+
+	iterator () noexcept = default;
+
+	iterator (list_t lst, list_iterator_t it) noexcept
+		: lst_(lst), it_(it)
+	{}
+
+	template <bool OtherConst,
+	          typename = std::enable_if_t<Const && !OtherConst>>
+	iterator (const iterator<T, OtherConst>& other) noexcept
+		: lst_(other.handle()), it_(other.native())
+	{}
+
+	reference operator* () const noexcept
+	{
+		return static_cast<pointer>(lst_->data)[it_];
+	}
+
+	pointer operator-> () const noexcept
+	{
+		return static_cast<pointer>(lst_->data) + it_;
+	}
+
+	iterator& operator++ () noexcept
+	{
+		it_ = lst_->nexts[it_];
+		return *this;
+	}
+
+	iterator operator++ (int) noexcept
+	{
+		iterator old = *this;
+		++*this;
+		return old;
+	}
+
+	iterator& operator-- () noexcept
+	{
+		it_ = lst_->prevs[it_];
+		return *this;
+	}
+
+	iterator operator-- (int) noexcept
+	{
+		iterator old = *this;
+		--*this;
+		return old;
+	}
+
+	friend bool operator== (const iterator& a, const iterator& b) noexcept
+	{
+		return a.it_ == b.it_ && a.lst_ == b.lst_;
+	}
+
+	friend bool operator!= (const iterator& a, const iterator& b) noexcept
+	{
+		return !(a == b);
+	}
+
+	/*!
+	 * @brief Get iterator of C list.
+	 */
+	list_iterator_t native () const noexcept { return it_; }
+
+	/*!
+	 * @brief Get C list.
+	 */
+	list_t handle () const noexcept { return lst_; }
+
+private:
+	list_t          lst_ = nullptr; /*!< list.                               */
+	list_iterator_t it_  = 0;       /*!< index of element.                   */
+};
+
+} // namespace detail
+
+#if __cplusplus >= 202002L
+
+/*!
+ * @brief Coroutine which lazily yields values of type T.
+ *
+ * It is an input range which can be passed once.
+ */
+template <typename T>
+class generator : public std::ranges::view_interface<generator<T>>
+{
+public:
+	struct promise_type
+	{
+		T* value = nullptr; /*!< last yielded value.                         */
+
+		generator get_return_object () noexcept
+		{
+			return generator(handle::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend () const noexcept { return {}; }
+		std::suspend_always final_suspend   () const noexcept { return {}; }
+
+		std::suspend_always yield_value (T& v) noexcept
+		{
+			value = std::addressof(v);
+			return {};
+		}
+
+		std::suspend_always yield_value (T&& v) noexcept
+		{
+			value = std::addressof(v);
+			return {};
+		}
+
+		void return_void         () const noexcept {}
+		void unhandled_exception () const          { throw; }
+
+		template <typename U>
+		std::suspend_never await_transform (U&&) = delete;
+	};
+
+	class iterator
+	{
+	public:
+		using value_type      = std::remove_cv_t<T>;
+		using difference_type = std::ptrdiff_t;
+
+		iterator () noexcept = default;
+
+		T& operator* () const noexcept { return *coro_.promise().value; }
+
+		iterator& operator++ ()
+		{
+			coro_.resume();
+			return *this;
+		}
+
+		void operator++ (int) { ++*this; }
+
+		friend bool operator== (const iterator& it,
+		                        std::default_sentinel_t) noexcept
+		{
+			return it.coro_.done();
+		}
+
+	private:
+		friend class generator;
+
+		explicit iterator (std::coroutine_handle<promise_type> coro) noexcept
+			: coro_(coro)
+		{}
+
+		std::coroutine_handle<promise_type> coro_; /*!< coroutine.          */
+	};
+
+	generator (generator&& other) noexcept
+		: coro_(std::exchange(other.coro_, nullptr))
+	{}
+
+	generator& operator= (generator&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (coro_)
+				coro_.destroy();
+			coro_ = std::exchange(other.coro_, nullptr);
+		}
+
+		return *this;
+	}
+
+	~generator ()
+	{
+		if (coro_)
+			coro_.destroy();
+	}
+
+	/*!
+	 * @brief Start coroutine. It can be called only once.
+	 */
+	iterator begin ()
+	{
+		coro_.resume();
+		return iterator(coro_);
+	}
+
+	std::default_sentinel_t end () const noexcept { return {}; }
+
+private:
+	using handle = std::coroutine_handle<promise_type>;
+
+	explicit generator (handle coro) noexcept
+		: coro_(coro)
+	{}
+
+	handle coro_; /*!< coroutine.                                            */
+};
+
+/*!
+ * @brief Non-owning bidirectional view of list of T elements.
+ *
+ * It can view C list too. T is const to get read-only view.
+ */
+template <typename T>
+class list_view : public std::ranges::view_interface<list_view<T>>
+{
+public:
+	using iterator = detail::iterator<std::remove_const_t<T>,
+	                                  std::is_const_v<T>>;
+
+	list_view () noexcept = default;
+
+	explicit list_view (list_t lst) noexcept
+		: lst_(lst)
+	{}
+
+	iterator    begin () const noexcept { return { lst_, lst_->head }; }
+	iterator    end   () const noexcept { return { lst_, 0 };          }
+	std::size_t size  () const noexcept { return lst_->size - 1;       }
+
+	/*!
+	 * @brief Get elements as contiguous range. Use it as fast path
+	 * of algorithms.
+	 *
+	 * @return Span of elements in the list order or nullopt if the list
+	 * isn't normalized.
+	 */
+	std::optional<std::span<T>> contiguous () const noexcept
+	{
+		if (!lst_->normalized)
+			return std::nullopt;
+
+		return std::span<T>(static_cast<T*>(lst_->data) + 1, lst_->size - 1);
+	}
+
+	/*!
+	 * @brief Lazily yield elements in the list order by batches
+	 * of at most amount elements. Every batch is a span of elements
+	 * which are consecutive in memory, so normalized list is passed
+	 * by full batches without copying.
+	 *
+	 * @note The list mustn't be changed while batches are yielded.
+	 */
+	generator<std::span<T>> batches (std::size_t amount) const
+	{
+		return make_batches(lst_, (amount) ? amount : 1);
+	}
+
+private:
+	static generator<std::span<T>> make_batches (list_t lst, std::size_t amount)
+	{
+		T*              data = static_cast<T*>(lst->data);
+		list_iterator_t it   = lst->head;
+		while (it)
+		{
+			std::size_t length = 1;
+			while (length < amount && lst->nexts[it + length - 1] == it + length)
+				++length;
+
+			list_iterator_t next = lst->nexts[it + length - 1];
+			co_yield std::span<T>(data + it, length);
+			it = next;
+		}
+	}
+
+	list_t lst_ = nullptr; /*!< viewed list.                                 */
+};
+
+#endif // C++20
+
+/*!
+ * @brief Owning wrapper of doubly linked list of T elements.
+ *
+ * It is move-only, use clone() to copy the list. Elements are accessed
+ * through typed pointers, so operations on them are inlined. Elements
+ * which aren't trivially relocatable are moved by their move constructor
+ * when list is normalized or its capacity is changed.
+ *
+ * Arrays of the list are allocated by Allocator. Default allocator keeps
+ * them in heap of C list, other allocators are used through list storage
+ * which holds a copy of allocator, so the list can be moved between
+ * wrappers regardless of their allocators.
+ *
+ * @note Like changes through pointers returned by list_get(), changes
+ * of elements through iterators and references aren't tracked for deltas
+ * and incremental checkpoints. Use touch() after them.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class list
+{
+	static_assert(is_trivially_relocatable_v<T>
+	              || std::is_nothrow_move_constructible_v<T>,
+	              "elements are moved while list is changed by C code");
+	static_assert(alignof(T) <= alignof(std::max_align_t),
+	              "arrays are aligned to max_align_t");
+
+public:
+	using value_type      = T;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T&;
+	using const_reference = const T&;
+	using iterator        = detail::iterator<T, false>;
+	using const_iterator  = detail::iterator<T, true>;
+	using reverse_iterator       = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+	using allocator_type         = Allocator;
+
+	/*!
+	 * @brief Create empty list.
+	 */
+	explicit list (size_type capacity = 0, const Allocator& alloc = Allocator())
+		: lst_(list_create_func_((uses_storage) ? 0 : capacity,
+		                         nullptr, sizeof (T)))
+	{
+		if (!lst_)
+			throw std::bad_alloc();
+
+		if constexpr (!is_trivially_relocatable_v<T>)
+			list_set_relocate(lst_, relocate);
+
+		if constexpr (uses_storage)
+		{
+			try
+			{
+				attach_storage(alloc);
+				reserve(capacity);
+			}
+			catch (...)
+			{
+				list_destroy(lst_);
+				throw;
+			}
+		}
+	}
+
+	explicit list (const Allocator& alloc)
+		: list(0, alloc)
+	{}
+
+	list (const list&)            = delete;
+	list& operator= (const list&) = delete;
+
+	list (list&& other) noexcept
+		: lst_(std::exchange(other.lst_, nullptr))
+	{}
+
+	list& operator= (list&& other) noexcept
+	{
+		if (this != &other)
+		{
+			destroy_elements();
+			list_destroy(lst_);
+			lst_ = std::exchange(other.lst_, nullptr);
+		}
+
+		return *this;
+	}
+
+	~list ()
+	{
+		destroy_elements();
+		list_destroy(lst_);
+	}
+
+	/*!
+	 * @brief Copy the list. Copy is normalized.
+	 */
+	list clone () const
+	{
+		list copy(size(), std::allocator_traits<Allocator>::
+		                  select_on_container_copy_construction(get_allocator()));
+		for (const T& value : *this)
+			copy.push_back(value);
+
+		return copy;
+	}
+
+	/*!
+	 * @brief Get allocator of arrays of the list.
+	 */
+	allocator_type get_allocator () const noexcept
+	{
+		if constexpr (uses_storage)
+			return static_cast<storage_ctx*>(lst_->storage_ctx)->alloc;
+		else
+			return Allocator();
+	}
+
+	size_type size     () const noexcept { return lst_->size - 1;     }
+	size_type capacity () const noexcept { return lst_->capacity - 1; }
+	bool      empty    () const noexcept { return lst_->size == 1;    }
+
+	/*!
+	 * @brief Increase capacity of the list.
+	 */
+	void reserve (size_type capacity)
+	{
+		if (capacity > this->capacity())
+			detail::check(list_change_capacity(lst_, capacity));
+	}
+
+	/*!
+	 * @brief Decrease capacity to size of the list.
+	 */
+	void shrink_to_fit ()
+	{
+		detail::check(list_change_capacity(lst_, size()));
+	}
+
+	iterator       begin  ()       noexcept { return { lst_, lst_->head }; }
+	const_iterator begin  () const noexcept { return { lst_, lst_->head }; }
+	const_iterator cbegin () const noexcept { return begin(); }
+	iterator       end    ()       noexcept { return { lst_, 0 }; }
+	const_iterator end    () const noexcept { return { lst_, 0 }; }
+	const_iterator cend   () const noexcept { return end(); }
+
+	reverse_iterator       rbegin ()       noexcept { return reverse_iterator(end());         }
+	const_reverse_iterator rbegin () const noexcept { return const_reverse_iterator(end());   }
+	reverse_iterator       rend   ()       noexcept { return reverse_iterator(begin());       }
+	const_reverse_iterator rend   () const noexcept { return const_reverse_iterator(begin()); }
+
+	/*!
+	 * @brief Get iterator before the first element. Inserting after it
+	 * inserts to head.
+	 */
+	iterator       before_begin ()       noexcept { return end(); }
+	const_iterator before_begin () const noexcept { return end(); }
+
+	reference       front ()       noexcept { return *begin();            }
+	const_reference front () const noexcept { return *begin();            }
+	reference       back  ()       noexcept { return *iterator(lst_, lst_->tail); }
+	const_reference back  () const noexcept { return *const_iterator(lst_, lst_->tail); }
+
+	/*!
+	 * @brief Construct element in place after the position.
+	 *
+	 * @return Iterator to new element.
+	 */
+	template <typename... Args>
+	iterator emplace_after (const_iterator pos, Args&&... args)
+	{
+		list_iterator_t place = 0;
+		detail::check(list_emplace_after(lst_, pos.native(), &place));
+
+		try
+		{
+			::new (static_cast<T*>(lst_->data) + place)
+				T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			list_emplace_cancel(lst_, place);
+			throw;
+		}
+
+		list_emplace_commit(lst_, place);
+		return { lst_, place };
+	}
+
+	/*!
+	 * @brief Construct element in place before the position.
+	 *
+	 * @return Iterator to new element.
+	 */
+	template <typename... Args>
+	iterator emplace (const_iterator pos, Args&&... args)
+	{
+		return emplace_after(const_iterator(lst_, lst_->prevs[pos.native()]),
+		                     std::forward<Args>(args)...);
+	}
+
+	template <typename... Args>
+	reference emplace_back (Args&&... args)
+	{
+		return *emplace_after(const_iterator(lst_, lst_->tail),
+		                      std::forward<Args>(args)...);
+	}
+
+	template <typename... Args>
+	reference emplace_front (Args&&... args)
+	{
+		return *emplace_after(before_begin(), std::forward<Args>(args)...);
+	}
+
+	iterator insert_after (const_iterator pos, const T& value)
+	{
+		return emplace_after(pos, value);
+	}
+
+	iterator insert (const_iterator pos, const T& value)
+	{
+		return emplace(pos, value);
+	}
+
+	void push_back  (const T& value) { emplace_back(value);  }
+	void push_front (const T& value) { emplace_front(value); }
+
+	/*!
+	 * @brief Erase element.
+	 *
+	 * @return Iterator to the next element.
+	 */
+	iterator erase (const_iterator pos)
+	{
+		list_iterator_t it = pos.native();
+		if (!list_check_iterator(lst_, it))
+			throw list_error(LIST_BAD_ITERATOR);
+		if (!it)
+			return end();
+
+		list_iterator_t next = lst_->nexts[it];
+		static_cast<T*>(lst_->data)[it].~T();
+		detail::check(list_erase(lst_, &it));
+
+		return { lst_, next };
+	}
+
+	void pop_back  () { erase(const_iterator(lst_, lst_->tail)); }
+	void pop_front () { erase(begin());                          }
+
+	void clear ()
+	{
+		destroy_elements();
+		detail::check(list_clear(lst_));
+	}
+
+	/*!
+	 * @brief Place elements in slots in the list order.
+	 *
+	 * @note It invalidates iterators.
+	 */
+	void normalize ()
+	{
+		list_normalize(lst_);
+	}
+
+	bool is_normalized () const noexcept { return lst_->normalized; }
+
+	/*!
+	 * @brief Mark element as changed for the next delta dump
+	 * and incremental checkpoint.
+	 */
+	void touch (const_iterator pos) noexcept
+	{
+		list_delta_touch(lst_, pos.native());
+	}
+
+	/*!
+	 * @brief Get C list. It stays owned by the wrapper.
+	 */
+	list_t native_handle () const noexcept { return lst_; }
+
+#if __cplusplus >= 202002L
+	/*!
+	 * @brief Get view of the list which can be used in range adaptors.
+	 */
+	list_view<T>       view ()       noexcept { return list_view<T>(lst_);       }
+	list_view<const T> view () const noexcept { return list_view<const T>(lst_); }
+#endif // C++20
+
+private:
+	/*!
+	 * @brief Is list storage used to allocate arrays by Allocator.
+	 */
+	static constexpr bool uses_storage =
+		!std::is_same_v<Allocator, std::allocator<T>>;
+
+	using traits       = std::allocator_traits<Allocator>;
+	using index_alloc  = typename traits::template rebind_alloc<size_t>;
+	using index_traits = typename traits::template rebind_traits<size_t>;
+
+	/*!
+	 * @brief Context of list storage.
+	 */
+	struct storage_ctx
+	{
+		Allocator alloc; /*!< allocator of arrays.                           */
+	};
+
+	using ctx_alloc  = typename traits::template rebind_alloc<storage_ctx>;
+	using ctx_traits = typename traits::template rebind_traits<storage_ctx>;
+
+	/*!
+	 * @brief Arrays of the list allocated by Allocator.
+	 */
+	struct arrays
+	{
+		T*      data;  /*!< array with data.                                 */
+		size_t* nexts; /*!< array with indexes of next elements.             */
+		size_t* prevs; /*!< array with indexes of previous elements.         */
+	};
+
+	/*!
+	 * @brief Allocate arrays of the capacity.
+	 */
+	static arrays allocate (Allocator& alloc, size_t capacity)
+	{
+		index_alloc indexes(alloc);
+		arrays      result = {};
+
+		result.data = traits::allocate(alloc, capacity);
+		try
+		{
+			result.nexts = index_traits::allocate(indexes, capacity);
+			try
+			{
+				result.prevs = index_traits::allocate(indexes, capacity);
+			}
+			catch (...)
+			{
+				index_traits::deallocate(indexes, result.nexts, capacity);
+				throw;
+			}
+		}
+		catch (...)
+		{
+			traits::deallocate(alloc, result.data, capacity);
+			throw;
+		}
+
+		return result;
+	}
+
+	/*!
+	 * @brief Deallocate arrays of the list. Elements must be destroyed
+	 * or relocated.
+	 */
+	static void deallocate (Allocator& alloc, list_t lst,
+	                        size_t capacity) noexcept
+	{
+		index_alloc indexes(alloc);
+
+		traits::deallocate(alloc, static_cast<T*>(lst->data), capacity);
+		index_traits::deallocate(indexes, lst->nexts, capacity);
+		index_traits::deallocate(indexes, lst->prevs, capacity);
+	}
+
+	/*!
+	 * @brief Replace arrays of the list by new ones keeping the first slots.
+	 */
+	static list_error_t storage_resize (list_t lst,
+	                                    size_t new_capacity) noexcept
+	{
+		Allocator& alloc = static_cast<storage_ctx*>(lst->storage_ctx)->alloc;
+
+		arrays new_arrays;
+		try
+		{
+			new_arrays = allocate(alloc, new_capacity);
+		}
+		catch (...)
+		{
+			return LIST_ALLOC_ERR;
+		}
+
+		size_t copy_capacity = (new_capacity < lst->capacity)
+		                       ? new_capacity : lst->capacity;
+
+		if constexpr (is_trivially_relocatable_v<T>)
+			std::memcpy(static_cast<void*>(new_arrays.data), lst->data,
+			            copy_capacity * sizeof (T));
+		else
+		{
+			T* old_data = static_cast<T*>(lst->data);
+			for (size_t i = 1; i < copy_capacity; ++i)
+				if (lst->prevs[i] != i)
+					relocate(new_arrays.data + i, old_data + i, 1);
+		}
+
+		std::memcpy(new_arrays.nexts, lst->nexts,
+		            copy_capacity * sizeof *lst->nexts);
+		std::memcpy(new_arrays.prevs, lst->prevs,
+		            copy_capacity * sizeof *lst->prevs);
+
+		deallocate(alloc, lst, lst->capacity);
+
+		lst->data  = new_arrays.data;
+		lst->nexts = new_arrays.nexts;
+		lst->prevs = new_arrays.prevs;
+
+		return LIST_NO_ERR;
+	}
+
+	/*!
+	 * @brief Release arrays and context of storage.
+	 */
+	static void storage_release (list_t lst) noexcept
+	{
+		storage_ctx* ctx = static_cast<storage_ctx*>(lst->storage_ctx);
+		ctx_alloc    alloc(ctx->alloc);
+
+		deallocate(ctx->alloc, lst, lst->capacity);
+		ctx_traits::destroy(alloc, ctx);
+		ctx_traits::deallocate(alloc, ctx, 1);
+	}
+
+	static constexpr list_storage_t storage = {
+		storage_resize,
+		storage_release,
+		nullptr,
+	};
+
+	/*!
+	 * @brief Replace heap arrays of just created list by arrays
+	 * allocated by Allocator.
+	 */
+	void attach_storage (const Allocator& alloc)
+	{
+		ctx_alloc    ctx_allocator(alloc);
+		storage_ctx* ctx = ctx_traits::allocate(ctx_allocator, 1);
+		try
+		{
+			ctx_traits::construct(ctx_allocator, ctx, storage_ctx{ alloc });
+		}
+		catch (...)
+		{
+			ctx_traits::deallocate(ctx_allocator, ctx, 1);
+			throw;
+		}
+
+		arrays heap = { static_cast<T*>(lst_->data), lst_->nexts, lst_->prevs };
+		arrays new_arrays;
+		try
+		{
+			new_arrays = allocate(ctx->alloc, lst_->capacity);
+		}
+		catch (...)
+		{
+			ctx_traits::destroy(ctx_allocator, ctx);
+			ctx_traits::deallocate(ctx_allocator, ctx, 1);
+			throw;
+		}
+
+		std::memcpy(new_arrays.nexts, heap.nexts,
+		            lst_->capacity * sizeof *heap.nexts);
+		std::memcpy(new_arrays.prevs, heap.prevs,
+		            lst_->capacity * sizeof *heap.prevs);
+
+		std::free(heap.data);
+		std::free(heap.nexts);
+		std::free(heap.prevs);
+
+		lst_->data        = new_arrays.data;
+		lst_->nexts       = new_arrays.nexts;
+		lst_->prevs       = new_arrays.prevs;
+		lst_->storage     = &storage;
+		lst_->storage_ctx = ctx;
+	}
+
+	/*!
+	 * @brief Move elements to uninitialized memory and destroy old ones.
+	 */
+	static void relocate (void* dst, void* src, size_t amount) noexcept
+	{
+		T* to   = static_cast<T*>(dst);
+		T* from = static_cast<T*>(src);
+		for (size_t i = 0; i < amount; ++i)
+		{
+			::new (to + i) T(std::move(from[i]));
+			from[i].~T();
+		}
+	}
+
+	/*!
+	 * @brief Call destructors of all elements.
+	 */
+	void destroy_elements () noexcept
+	{
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			if (!lst_)
+				return;
+
+			for (T& value : *this)
+				value.~T();
+		}
+	}
+
+	list_t lst_; /*!< C list.                                                */
+};
+
+namespace pmr
+{
+
+/*!
+ * @brief List which allocates arrays from std::pmr::memory_resource.
+ */
+template <typename T>
+using list = dll::list<T, std::pmr::polymorphic_allocator<T>>;
+
+} // namespace pmr
+
+} // namespace dll
+
+#if __cplusplus >= 202002L
+template <typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<dll::list_view<T>> =
+	true;
+#endif // C++20
+
+
+
+
+#endif // undefined LIST_HPP_
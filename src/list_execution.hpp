@@ -0,0 +1,328 @@
+/*!
+ * @brief Header file with parallel algorithms over C++ lists.
+ *
+ * Algorithms take standard execution policies. Normalized list is passed
+ * to standard parallel algorithm as contiguous array. Other lists are
+ * processed by sweep over all slots which skips free ones, when order
+ * of elements doesn't matter, and sequentially otherwise.
+ *
+ * for_each() and transform() of list in place mark all elements as changed
+ * for deltas and incremental checkpoints when they are tracked.
+ *
+ * @note With GCC link the program with TBB (-ltbb).
+ */
+
+
+#ifndef LIST_EXECUTION_HPP_
+#define LIST_EXECUTION_HPP_
+
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "list.hpp"
+
+
+
+
+namespace dll
+{
+
+namespace detail
+{
+
+template <typename Policy>
+using enable_if_policy_t =
+	std::enable_if_t<std::is_execution_policy_v<std::decay_t<Policy>>>;
+
+/*!
+ * @brief Random access iterator over indexes of slots. Parallel algorithms
+ * take range of indexes and read slots by them.
+ */
+class index_iterator
+{
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type        = size_t;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = const size_t*;
+	using reference         = size_t;
+
+	index_iterator () noexcept = default;
+
+	explicit index_iterator (size_t i) noexcept
+		: i_(i)
+	{}
+
+	size_t operator*  ()                  const noexcept { return i_;     }
+	size_t operator[] (difference_type n) const noexcept { return i_ + n; }
+
+	index_iterator& operator++ ()    noexcept { ++i_; return *this; }
+	index_iterator& operator-- ()    noexcept { --i_; return *this; }
+	index_iterator  operator++ (int) noexcept { return index_iterator(i_++); }
+	index_iterator  operator-- (int) noexcept { return index_iterator(i_--); }
+
+	index_iterator& operator+= (difference_type n) noexcept { i_ += n; return *this; }
+	index_iterator& operator-= (difference_type n) noexcept { i_ -= n; return *this; }
+
+	friend index_iterator operator+ (index_iterator it, difference_type n) noexcept
+	{
+		return it += n;
+	}
+
+	friend index_iterator operator+ (difference_type n, index_iterator it) noexcept
+	{
+		return it += n;
+	}
+
+	friend index_iterator operator- (index_iterator it, difference_type n) noexcept
+	{
+		return it -= n;
+	}
+
+	friend difference_type operator- (index_iterator a, index_iterator b) noexcept
+	{
+		return static_cast<difference_type>(a.i_ - b.i_);
+	}
+
+	friend bool operator== (index_iterator a, index_iterator b) noexcept { return a.i_ == b.i_; }
+	friend bool operator!= (index_iterator a, index_iterator b) noexcept { return a.i_ != b.i_; }
+	friend bool operator<  (index_iterator a, index_iterator b) noexcept { return a.i_ <  b.i_; }
+	friend bool operator>  (index_iterator a, index_iterator b) noexcept { return a.i_ >  b.i_; }
+	friend bool operator<= (index_iterator a, index_iterator b) noexcept { return a.i_ <= b.i_; }
+	friend bool operator>= (index_iterator a, index_iterator b) noexcept { return a.i_ >= b.i_; }
+
+private:
+	size_t i_ = 0; /*!< index of slot.                                       */
+};
+
+/*!
+ * @brief Get typed data array of the list.
+ */
+template <typename T>
+T* slots (list_t lst) noexcept
+{
+	return static_cast<T*>(lst->data);
+}
+
+/*!
+ * @brief Call f(element) for every element of the list in any order.
+ *
+ * Sweep walks over indexes of slots: slot is free if it is previous
+ * for itself.
+ */
+template <typename T, typename Policy, typename F>
+void sweep (Policy&& policy, list_t lst, F&& f)
+{
+	T*            data  = slots<T>(lst);
+	const size_t* prevs = lst->prevs;
+
+	if (lst->normalized)
+	{
+		std::for_each(std::forward<Policy>(policy),
+		              data + 1, data + lst->size, f);
+		return;
+	}
+
+	std::for_each(std::forward<Policy>(policy),
+	              index_iterator(1), index_iterator(lst->capacity),
+	              [&] (size_t it)
+	              {
+	                  if (prevs[it] != it)
+	                      f(data[it]);
+	              });
+}
+
+/*!
+ * @brief Mark all elements as changed if changes of the list are tracked.
+ *
+ * Bitmaps of changes aren't atomic, so elements are marked sequentially
+ * after parallel algorithm.
+ */
+inline void touch_all (list_t lst) noexcept
+{
+	if (!lst->dirty && !lst->chunks)
+		return;
+
+	for (list_iterator_t it = lst->head; it; it = lst->nexts[it])
+		list_delta_touch(lst, it);
+}
+
+} // namespace detail
+
+/*!
+ * @brief Apply f to every element of the list in parallel.
+ */
+template <typename Policy, typename T, typename A, typename F,
+          typename = detail::enable_if_policy_t<Policy>>
+void for_each (Policy&& policy, list<T, A>& lst, F f)
+{
+	detail::sweep<T>(std::forward<Policy>(policy), lst.native_handle(), f);
+	detail::touch_all(lst.native_handle());
+}
+
+template <typename Policy, typename T, typename A, typename F,
+          typename = detail::enable_if_policy_t<Policy>>
+void for_each (Policy&& policy, const list<T, A>& lst, F f)
+{
+	detail::sweep<const T>(std::forward<Policy>(policy),
+	                       lst.native_handle(), f);
+}
+
+/*!
+ * @brief Replace every element of the list by op(element) in parallel.
+ */
+template <typename Policy, typename T, typename A, typename UnaryOp,
+          typename = detail::enable_if_policy_t<Policy>>
+void transform (Policy&& policy, list<T, A>& lst, UnaryOp op)
+{
+	detail::sweep<T>(std::forward<Policy>(policy), lst.native_handle(),
+	                 [&] (T& value) { value = op(value); });
+	detail::touch_all(lst.native_handle());
+}
+
+/*!
+ * @brief Write op(element) for elements in the list order to d_first.
+ *
+ * It is parallel only for normalized list.
+ *
+ * @return Iterator past the last written value.
+ */
+template <typename Policy, typename T, typename A, typename OutIt,
+          typename UnaryOp, typename = detail::enable_if_policy_t<Policy>>
+OutIt transform (Policy&& policy, const list<T, A>& lst,
+                 OutIt d_first, UnaryOp op)
+{
+	list_t handle = lst.native_handle();
+	if (handle->normalized)
+	{
+		const T* data = detail::slots<const T>(handle);
+		return std::transform(std::forward<Policy>(policy),
+		                      data + 1, data + handle->size, d_first, op);
+	}
+
+	return std::transform(lst.begin(), lst.end(), d_first, op);
+}
+
+/*!
+ * @brief Reduce elements of the list in parallel. Operation must be
+ * associative and commutative.
+ *
+ * @return Reduced value.
+ */
+template <typename Policy, typename T, typename A, typename U,
+          typename BinaryOp = std::plus<>,
+          typename = detail::enable_if_policy_t<Policy>>
+U reduce (Policy&& policy, const list<T, A>& lst, U init,
+          BinaryOp op = BinaryOp())
+{
+	list_t   handle = lst.native_handle();
+	const T* data   = detail::slots<const T>(handle);
+
+	if (handle->normalized)
+		return std::reduce(std::forward<Policy>(policy),
+		                   data + 1, data + handle->size, std::move(init), op);
+
+	// Free slots have no identity value, so they are empty optionals.
+	const size_t*    prevs  = handle->prevs;
+	std::optional<U> result = std::transform_reduce(
+		std::forward<Policy>(policy),
+		detail::index_iterator(1), detail::index_iterator(handle->capacity),
+		std::optional<U>(),
+		[&] (std::optional<U> lhs, std::optional<U> rhs) -> std::optional<U>
+		{
+			if (!lhs)
+				return rhs;
+			if (!rhs)
+				return lhs;
+			return op(std::move(*lhs), std::move(*rhs));
+		},
+		[&] (size_t it) -> std::optional<U>
+		{
+			if (prevs[it] == it)
+				return std::nullopt;
+			return U(data[it]);
+		});
+
+	return (result) ? op(std::move(init), std::move(*result)) : init;
+}
+
+/*!
+ * @brief Count elements satisfying the predicate in parallel.
+ *
+ * @return Amount of elements.
+ */
+template <typename Policy, typename T, typename A, typename Pred,
+          typename = detail::enable_if_policy_t<Policy>>
+size_t count_if (Policy&& policy, const list<T, A>& lst, Pred pred)
+{
+	list_t   handle = lst.native_handle();
+	const T* data   = detail::slots<const T>(handle);
+
+	if (handle->normalized)
+		return static_cast<size_t>(
+			std::count_if(std::forward<Policy>(policy),
+			              data + 1, data + handle->size, pred));
+
+	const size_t* prevs = handle->prevs;
+	return std::transform_reduce(
+		std::forward<Policy>(policy),
+		detail::index_iterator(1), detail::index_iterator(handle->capacity),
+		size_t(0), std::plus<>(),
+		[&] (size_t it) -> size_t
+		{
+			return prevs[it] != it && pred(data[it]);
+		});
+}
+
+/*!
+ * @brief Find the first element in the list order satisfying
+ * the predicate. It is parallel only for normalized list.
+ *
+ * @return Iterator to element or end() if it isn't found.
+ */
+template <typename Policy, typename T, typename A, typename Pred,
+          typename = detail::enable_if_policy_t<Policy>>
+typename list<T, A>::iterator find_if (Policy&& policy, list<T, A>& lst,
+                                       Pred pred)
+{
+	list_t handle = lst.native_handle();
+	if (!handle->normalized)
+		return std::find_if(lst.begin(), lst.end(), pred);
+
+	T* data  = detail::slots<T>(handle);
+	T* found = std::find_if(std::forward<Policy>(policy),
+	                        data + 1, data + handle->size, pred);
+
+	return { handle, (found == data + handle->size)
+	                 ? 0 : static_cast<list_iterator_t>(found - data) };
+}
+
+template <typename Policy, typename T, typename A, typename Pred,
+          typename = detail::enable_if_policy_t<Policy>>
+typename list<T, A>::const_iterator find_if (Policy&& policy,
+                                             const list<T, A>& lst, Pred pred)
+{
+	list_t handle = lst.native_handle();
+	if (!handle->normalized)
+		return std::find_if(lst.begin(), lst.end(), pred);
+
+	const T* data  = detail::slots<const T>(handle);
+	const T* found = std::find_if(std::forward<Policy>(policy),
+	                              data + 1, data + handle->size, pred);
+
+	return { handle, (found == data + handle->size)
+	                 ? 0 : static_cast<list_iterator_t>(found - data) };
+}
+
+} // namespace dll
+
+
+
+
+#endif // undefined LIST_EXECUTION_HPP_
@@ -0,0 +1,936 @@
+/*!
+ * @file Saving and loading of doubly linked lists.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "list_io.h"
+
+
+
+
+/*!
+ * @brief Magic number of saved list.
+ */
+#define LIST_FILE_MAGIC "LSTF"
+
+/*!
+ * @brief Version of saved list format.
+ */
+#define LIST_FILE_VERSION ((uint32_t) 1)
+
+/*!
+ * @brief Mode of header written by list_checkpoint_incremental().
+ * It isn't a value of list_save_mode_t.
+ */
+#define LIST_FILE_CHUNKS ((uint32_t) 2)
+
+/*!
+ * @brief Maximal size of encoded number.
+ */
+#define LIST_IO_NUMBER_MAX 10
+
+/*!
+ * @brief Header of saved list.
+ */
+typedef struct
+{
+	char     magic[4];   /*!< LIST_FILE_MAGIC.                               */
+	uint32_t version;    /*!< LIST_FILE_VERSION.                             */
+	uint32_t mode;       /*!< list_save_mode_t or LIST_FILE_CHUNKS.          */
+	uint32_t reserved;   /*!< zero.                                          */
+	uint64_t index_size; /*!< size of one element of nexts and prevs.        */
+	uint64_t elem_size;  /*!< size of one element.                           */
+	uint64_t size;       /*!< amount of elements including virtual one.      */
+	uint64_t capacity;   /*!< capacity including virtual element.            */
+	uint64_t first_free; /*!< index of first free element.                   */
+	uint64_t head;       /*!< head of the list.                              */
+	uint64_t tail;       /*!< tail of the list.                              */
+	uint64_t normalized; /*!< is list normalized.                            */
+}
+list_file_header_t;
+
+
+
+
+/*!
+ * @brief Fill header of saved list with fields of the list.
+ */
+static void list_io_fill_header
+(
+	const list_t        lst,    /*!< [in]  list.                             */
+	uint32_t            mode,   /*!< [in]  mode of saving.                   */
+	list_file_header_t* header  /*!< [out] header.                           */
+)
+{
+	memset(header, 0, sizeof *header);
+	memcpy(header->magic, LIST_FILE_MAGIC, sizeof header->magic);
+
+	header->version    = LIST_FILE_VERSION;
+	header->mode       = mode;
+	header->index_size = sizeof *lst->nexts;
+	header->elem_size  = lst->elem_size;
+	header->size       = lst->size;
+	header->capacity   = lst->capacity;
+	header->first_free = lst->first_free;
+	header->head       = lst->head;
+	header->tail       = lst->tail;
+	header->normalized = lst->normalized;
+}
+
+/*!
+ * @brief Write whole buffer to file descriptor.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_write
+(
+	int         fd,   /*!< [in] file descriptor.                             */
+	const void* buf,  /*!< [in] buffer.                                      */
+	size_t      size  /*!< [in] size of buffer.                              */
+)
+{
+	const char* ptr = (const char*) buf;
+	while (size)
+	{
+		ssize_t written = write(fd, ptr, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return LIST_IO_ERR;
+
+		ptr  += written;
+		size -= (size_t) written;
+	}
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Read whole buffer from file descriptor.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_read
+(
+	int    fd,   /*!< [in]  file descriptor.                                 */
+	void*  buf,  /*!< [out] buffer.                                          */
+	size_t size  /*!< [in]  size of buffer.                                  */
+)
+{
+	char* ptr = (char*) buf;
+	while (size)
+	{
+		ssize_t got = read(fd, ptr, size);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got < 0)
+			return LIST_IO_ERR;
+		if (got == 0)
+			return LIST_BAD_FORMAT;
+
+		ptr  += got;
+		size -= (size_t) got;
+	}
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Write whole segments to file descriptor.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_writev
+(
+	int           fd,    /*!< [in]     file descriptor.                      */
+	struct iovec* iov,   /*!< [in,out] segments. They are changed.           */
+	int           count  /*!< [in]     amount of segments.                   */
+)
+{
+	while (count)
+	{
+		ssize_t written = writev(fd, iov, count);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return LIST_IO_ERR;
+
+		while (count && (size_t) written >= iov->iov_len)
+		{
+			written -= (ssize_t) iov->iov_len;
+			++iov;
+			--count;
+		}
+
+		if (count)
+		{
+			iov->iov_base  = (char*) iov->iov_base + written;
+			iov->iov_len  -= (size_t) written;
+		}
+	}
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief State of writing elements by segments.
+ */
+typedef struct
+{
+	int          fd;                      /*!< file descriptor.              */
+	struct iovec iov[LIST_IO_SEGMENTS];   /*!< segments to write.            */
+	int          count;                   /*!< amount of segments.           */
+	char*        buffer;                  /*!< buffer for short stretches.   */
+	size_t       buffer_size;             /*!< size of buffer.               */
+	size_t       used;                    /*!< used bytes of buffer.         */
+	size_t       gathered;                /*!< bytes of buffer which are
+	                                           already added to segments.    */
+}
+list_io_segments_t;
+
+/*!
+ * @brief Add gathered part of the buffer to segments.
+ */
+static void list_io_close_gathered
+(
+	list_io_segments_t* seg /*!< [in,out] state of writing.                  */
+)
+{
+	if (seg->used == seg->gathered)
+		return;
+
+	seg->iov[seg->count].iov_base = seg->buffer + seg->gathered;
+	seg->iov[seg->count].iov_len  = seg->used - seg->gathered;
+	seg->count++;
+	seg->gathered = seg->used;
+}
+
+/*!
+ * @brief Write all segments and reset the buffer.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_flush_segments
+(
+	list_io_segments_t* seg /*!< [in,out] state of writing.                  */
+)
+{
+	list_io_close_gathered(seg);
+
+	list_error_t err = list_io_writev(seg->fd, seg->iov, seg->count);
+
+	seg->count    = 0;
+	seg->used     = 0;
+	seg->gathered = 0;
+	return err;
+}
+
+/*!
+ * @brief Add contiguous stretch of elements to segments.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_add_stretch
+(
+	list_io_segments_t* seg,   /*!< [in,out] state of writing.               */
+	const char*         ptr,   /*!< [in]     first element of stretch.       */
+	size_t              bytes  /*!< [in]     size of stretch.                */
+)
+{
+	list_error_t err = LIST_NO_ERR;
+
+	// One segment is kept for the gathered part of the buffer.
+	if (seg->count >= LIST_IO_SEGMENTS - 1
+	    || (bytes < LIST_IO_SEGMENT_MIN
+	        && seg->used + bytes > seg->buffer_size))
+		err = list_io_flush_segments(seg);
+
+	if (bytes < LIST_IO_SEGMENT_MIN)
+	{
+		memcpy(seg->buffer + seg->used, ptr, bytes);
+		seg->used += bytes;
+	}
+	else
+	{
+		list_io_close_gathered(seg);
+		seg->iov[seg->count].iov_base = (void*) ptr;
+		seg->iov[seg->count].iov_len  = bytes;
+		seg->count++;
+	}
+
+	return err;
+}
+
+
+/*!
+ * @brief Load elements saved by list_write_to_fd().
+ *
+ * @return Loaded list or NULL if some error has been occurred.
+ */
+static list_t list_io_read_payload
+(
+	int                       fd,         /*!< [in] file descriptor.         */
+	const list_file_header_t* header,     /*!< [in] header of saved list.    */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+)
+{
+	size_t amount = (size_t) header->size - 1;
+
+	list_t lst = list_create_func_(amount, print_func,
+	                               (size_t) header->elem_size);
+	if (!lst)
+		return NULL;
+
+	if (list_io_read(fd, (char*) lst->data + lst->elem_size,
+	                 amount * lst->elem_size) != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	for (size_t i = 1; i <= amount; ++i)
+	{
+		lst->nexts[i] = (i + 1) % (amount + 1);
+		lst->prevs[i] = i - 1;
+	}
+
+	lst->size       = amount + 1;
+	lst->head       = (amount) ? 1 : 0;
+	lst->tail       = amount;
+	lst->first_free = 0;
+	lst->normalized = true;
+	lst->nexts[0]   = lst->head;
+	lst->prevs[0]   = lst->tail;
+
+	return lst;
+}
+
+/*!
+ * @brief Encode number as varint.
+ *
+ * @return Amount of bytes which are written or would be written
+ * if buffer is NULL.
+ */
+static size_t list_io_encode
+(
+	unsigned char* buffer, /*!< [out] buffer or NULL.                        */
+	uint64_t       number  /*!< [in]  number.                                */
+)
+{
+	size_t len = 0;
+	while (number >= 0x80)
+	{
+		if (buffer)
+			buffer[len] = (unsigned char) (number | 0x80);
+		++len;
+		number >>= 7;
+	}
+	if (buffer)
+		buffer[len] = (unsigned char) number;
+
+	return len + 1;
+}
+
+/*!
+ * @brief Decode varint.
+ *
+ * @return Amount of read bytes or 0 if number is wrong.
+ */
+static size_t list_io_decode
+(
+	const unsigned char* buffer, /*!< [in]  buffer.                          */
+	size_t               size,   /*!< [in]  size of buffer.                  */
+	uint64_t*            number  /*!< [out] number.                          */
+)
+{
+	*number = 0;
+	for (size_t len = 0; len < size && len < LIST_IO_NUMBER_MAX; ++len)
+	{
+		*number |= (uint64_t) (buffer[len] & 0x7f) << (7 * len);
+		if (!(buffer[len] & 0x80))
+			return len + 1;
+	}
+
+	return 0;
+}
+
+/*!
+ * @brief Encode nexts array of the list.
+ *
+ * @return Size of encoded links or amount of bytes which would be written
+ * if buffer is NULL.
+ */
+static size_t list_io_encode_links
+(
+	const list_t   lst,    /*!< [in]  list.                                  */
+	unsigned char* buffer  /*!< [out] buffer or NULL.                        */
+)
+{
+	size_t size  = 0;
+	size_t zeros = 0;
+	for (size_t i = 0; i < lst->capacity; ++i)
+	{
+		uint64_t delta = (uint64_t) lst->nexts[i] - (i + 1);
+		if (!delta)
+		{
+			++zeros;
+			continue;
+		}
+
+		uint64_t zigzag = (delta << 1) ^ (uint64_t) ((int64_t) delta >> 63);
+
+		size  += list_io_encode((buffer) ? buffer + size : NULL, zeros);
+		size  += list_io_encode((buffer) ? buffer + size : NULL, zigzag);
+		zeros  = 0;
+	}
+
+	if (zeros)
+		size += list_io_encode((buffer) ? buffer + size : NULL, zeros);
+
+	return size;
+}
+
+/*!
+ * @brief Decode nexts array of the list.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_decode_links
+(
+	list_t               lst,    /*!< [in,out] list with allocated arrays.   */
+	const unsigned char* buffer, /*!< [in]     encoded links.                */
+	size_t               size    /*!< [in]     size of encoded links.        */
+)
+{
+	size_t pos = 0;
+	size_t i   = 0;
+	while (i < lst->capacity)
+	{
+		uint64_t zeros = 0;
+		size_t   len   = list_io_decode(buffer + pos, size - pos, &zeros);
+		if (!len || zeros > lst->capacity - i)
+			return LIST_BAD_FORMAT;
+		pos += len;
+
+		for (size_t end = i + (size_t) zeros; i < end; ++i)
+			lst->nexts[i] = i + 1;
+
+		if (i == lst->capacity)
+			break;
+
+		uint64_t zigzag = 0;
+		len = list_io_decode(buffer + pos, size - pos, &zigzag);
+		if (!len)
+			return LIST_BAD_FORMAT;
+		pos += len;
+
+		lst->nexts[i] = i + 1 + ((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+		++i;
+	}
+
+	for (size_t j = 0; j < lst->capacity; ++j)
+		if (lst->nexts[j] >= lst->capacity)
+			return LIST_BAD_FORMAT;
+
+	return (pos == size) ? LIST_NO_ERR : LIST_BAD_FORMAT;
+}
+
+/*!
+ * @brief Restore prevs array from nexts array. Free slots are found
+ * by walking free chain.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_restore_prevs
+(
+	list_t lst /*!< [in,out] list with decoded nexts array.                  */
+)
+{
+	for (size_t i = 0; i < lst->capacity; ++i)
+		lst->prevs[i] = lst->capacity;
+
+	size_t steps = 0;
+	for (size_t it = lst->first_free; it; it = lst->nexts[it])
+	{
+		if (++steps > lst->capacity || lst->prevs[it] != lst->capacity)
+			return LIST_BAD_FORMAT;
+		lst->prevs[it] = it;
+	}
+
+	size_t prev = 0;
+	steps = 0;
+	do
+	{
+		size_t it = lst->nexts[prev];
+		if (++steps > lst->capacity || lst->prevs[it] != lst->capacity)
+			return LIST_BAD_FORMAT;
+
+		lst->prevs[it] = prev;
+		prev           = it;
+	}
+	while (prev);
+
+	for (size_t i = 0; i < lst->capacity; ++i)
+		if (lst->prevs[i] == lst->capacity)
+			return LIST_BAD_FORMAT;
+
+	return (steps == lst->size) ? LIST_NO_ERR : LIST_BAD_FORMAT;
+}
+
+/*!
+ * @brief Write nexts array and elements in LIST_SAVE_COMPRESSED mode.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_write_compressed
+(
+	const list_t lst, /*!< [in] list.                                        */
+	int          fd   /*!< [in] file descriptor.                             */
+)
+{
+	uint64_t       links_size = list_io_encode_links(lst, NULL);
+	unsigned char* links      = (unsigned char*) malloc((size_t) links_size);
+
+	list_io_segments_t seg;
+	seg.fd          = fd;
+	seg.count       = 0;
+	seg.buffer_size = LIST_IO_BUFFER;
+	seg.buffer      = (char*) malloc(seg.buffer_size);
+	seg.used        = 0;
+	seg.gathered    = 0;
+
+	list_error_t err = (links && seg.buffer) ? LIST_NO_ERR : LIST_ALLOC_ERR;
+	if (err == LIST_NO_ERR)
+	{
+		list_io_encode_links(lst, links);
+		err = list_io_add_stretch(&seg, (char*) &links_size,
+		                          sizeof links_size);
+	}
+	if (err == LIST_NO_ERR)
+		err = list_io_add_stretch(&seg, (char*) links, (size_t) links_size);
+
+	for (size_t i = 1; i < lst->capacity && err == LIST_NO_ERR; ++i)
+	{
+		if (lst->prevs[i] == i)
+			continue;
+
+		size_t first = i;
+		while (i + 1 < lst->capacity && lst->prevs[i + 1] != i + 1)
+			++i;
+
+		err = list_io_add_stretch(&seg,
+		                          (char*) lst->data + first * lst->elem_size,
+		                          (i - first + 1) * lst->elem_size);
+	}
+
+	if (err == LIST_NO_ERR)
+		err = list_io_flush_segments(&seg);
+
+	free(seg.buffer);
+	free(links);
+	return err;
+}
+
+/*!
+ * @brief Check links of loaded list without dumping it.
+ *
+ * Every index is checked against capacity before it is followed,
+ * so list_verify() can't read out of arrays after this check.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_io_check_links
+(
+	const list_t lst /*!< [in] loaded list.                                  */
+)
+{
+	if (!lst->size || lst->size > lst->capacity
+	    || lst->head >= lst->capacity || lst->tail >= lst->capacity
+	    || lst->first_free >= lst->capacity)
+		return LIST_BAD_FORMAT;
+
+	for (size_t i = 0; i < lst->capacity; ++i)
+		if (lst->nexts[i] >= lst->capacity || lst->prevs[i] >= lst->capacity)
+			return LIST_BAD_FORMAT;
+
+	size_t steps = 0;
+	for (size_t it = lst->first_free; it; it = lst->nexts[it])
+		if (++steps > lst->capacity - lst->size
+		    || lst->prevs[it] != it || lst->nexts[it] == it)
+			return LIST_BAD_FORMAT;
+
+	steps = 0;
+	for (size_t it = lst->nexts[0]; it; it = lst->nexts[it])
+		if (++steps >= lst->size || lst->prevs[it] == it
+		    || lst->prevs[lst->nexts[it]] != it)
+			return LIST_BAD_FORMAT;
+
+	return (steps + 1 == lst->size && lst->head == lst->nexts[0]
+	        && lst->tail == lst->prevs[0]
+	        && lst->nexts[lst->prevs[0]] == 0) ? LIST_NO_ERR : LIST_BAD_FORMAT;
+}
+
+/*!
+ * @brief Load list saved in LIST_SAVE_COMPRESSED mode.
+ *
+ * @return Loaded list or NULL if some error has been occurred.
+ */
+static list_t list_io_read_compressed
+(
+	int                       fd,         /*!< [in] file descriptor.         */
+	const list_file_header_t* header,     /*!< [in] header of saved list.    */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+)
+{
+	uint64_t links_size = 0;
+	if (list_io_read(fd, &links_size, sizeof links_size) != LIST_NO_ERR
+	    || links_size > header->capacity * LIST_IO_NUMBER_MAX * 2)
+		return NULL;
+
+	list_t lst = list_create_func_((size_t) header->capacity - 1, print_func,
+	                               (size_t) header->elem_size);
+	unsigned char* links = (unsigned char*) malloc((size_t) links_size + 1);
+	if (!lst || !links)
+	{
+		free(links);
+		return list_destroy(lst);
+	}
+
+	lst->size       = (size_t) header->size;
+	lst->first_free = (size_t) header->first_free;
+	lst->head       = (size_t) header->head;
+	lst->tail       = (size_t) header->tail;
+	lst->normalized = header->normalized;
+
+	list_error_t err = list_io_read(fd, links, (size_t) links_size);
+	if (err == LIST_NO_ERR)
+		err = list_io_decode_links(lst, links, (size_t) links_size);
+	free(links);
+
+	if (err == LIST_NO_ERR && lst->size <= lst->capacity
+	    && lst->first_free < lst->capacity)
+		err = list_io_restore_prevs(lst);
+	else
+		err = LIST_BAD_FORMAT;
+
+	for (size_t i = 1; i < lst->capacity && err == LIST_NO_ERR; ++i)
+	{
+		if (lst->prevs[i] == i)
+			continue;
+
+		size_t first = i;
+		while (i + 1 < lst->capacity && lst->prevs[i + 1] != i + 1)
+			++i;
+
+		err = list_io_read(fd, (char*) lst->data + first * lst->elem_size,
+		                   (i - first + 1) * lst->elem_size);
+	}
+
+	if (err != LIST_NO_ERR || list_io_check_links(lst) != LIST_NO_ERR
+	    || list_verify(lst) != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	return lst;
+}
+
+/*!
+ * @brief Load raw arrays saved in LIST_SAVE_EXACT mode.
+ *
+ * @return Loaded list or NULL if some error has been occurred.
+ */
+static list_t list_io_read_exact
+(
+	int                       fd,         /*!< [in] file descriptor.         */
+	const list_file_header_t* header,     /*!< [in] header of saved list.    */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+)
+{
+	list_t lst = list_create_func_((size_t) header->capacity - 1, print_func,
+	                               (size_t) header->elem_size);
+	if (!lst)
+		return NULL;
+
+	if (list_io_read(fd, lst->data, lst->capacity * lst->elem_size)
+	    != LIST_NO_ERR
+	    || list_io_read(fd, lst->nexts, lst->capacity * sizeof *lst->nexts)
+	       != LIST_NO_ERR
+	    || list_io_read(fd, lst->prevs, lst->capacity * sizeof *lst->prevs)
+	       != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	lst->size       = (size_t) header->size;
+	lst->first_free = (size_t) header->first_free;
+	lst->head       = (size_t) header->head;
+	lst->tail       = (size_t) header->tail;
+	lst->normalized = header->normalized;
+
+	if (list_io_check_links(lst) != LIST_NO_ERR
+	    || list_verify(lst) != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	return lst;
+}
+
+
+
+
+list_error_t list_save (const list_t lst, int fd, list_save_mode_t mode)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	list_file_header_t header;
+	list_io_fill_header(lst, mode, &header);
+
+	list_error_t err = list_io_write(fd, &header, sizeof header);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	switch (mode)
+	{
+		case LIST_SAVE_PAYLOAD:
+			return list_write_to_fd(lst, fd);
+
+		case LIST_SAVE_EXACT:
+			err = list_io_write(fd, lst->data,
+			                    lst->capacity * lst->elem_size);
+			if (err == LIST_NO_ERR)
+				err = list_io_write(fd, lst->nexts,
+				                    lst->capacity * sizeof *lst->nexts);
+			if (err == LIST_NO_ERR)
+				err = list_io_write(fd, lst->prevs,
+				                    lst->capacity * sizeof *lst->prevs);
+			return err;
+
+		case LIST_SAVE_COMPRESSED:
+			return list_io_write_compressed(lst, fd);
+
+		default:
+			return LIST_BAD_FORMAT;
+	}
+}
+
+
+list_error_t list_write_to_fd (const list_t lst, int fd)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (lst->normalized)
+		return list_io_write(fd, (char*) lst->data + lst->elem_size,
+		                     (lst->size - 1) * lst->elem_size);
+
+	list_io_segments_t seg;
+	seg.fd          = fd;
+	seg.count       = 0;
+	seg.buffer_size = (LIST_IO_BUFFER / lst->elem_size + 1) * lst->elem_size;
+	seg.buffer      = (char*) malloc(seg.buffer_size);
+	seg.used        = 0;
+	seg.gathered    = 0;
+	if (!seg.buffer)
+		return LIST_ALLOC_ERR;
+
+	list_error_t    err = LIST_NO_ERR;
+	list_iterator_t it  = lst->head;
+	while (it && err == LIST_NO_ERR)
+	{
+		list_iterator_t first = it;
+		while (lst->nexts[it] == it + 1)
+			++it;
+
+		err = list_io_add_stretch(&seg,
+		                          (char*) lst->data + first * lst->elem_size,
+		                          (it - first + 1) * lst->elem_size);
+		it  = lst->nexts[it];
+	}
+
+	if (err == LIST_NO_ERR)
+		err = list_io_flush_segments(&seg);
+
+	free(seg.buffer);
+	return err;
+}
+
+
+list_error_t list_checkpoint_incremental (list_t lst, int fd)
+{
+	assert (lst);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (!lst->chunks)
+	{
+		lst->chunks = (unsigned char*) malloc(LIST_CHUNKS_SIZE(lst->capacity));
+		if (!lst->chunks)
+			return LIST_ALLOC_ERR;
+
+		memset(lst->chunks, 0xff, LIST_CHUNKS_SIZE(lst->capacity));
+	}
+
+	size_t   chunks = (lst->capacity + LIST_CHUNK_SLOTS - 1) / LIST_CHUNK_SLOTS;
+	uint64_t amount = 0;
+	for (size_t i = 0; i < chunks; ++i)
+		amount += lst->chunks[i / 8] >> (i % 8) & 1;
+
+	list_file_header_t header;
+	list_io_fill_header(lst, LIST_FILE_CHUNKS, &header);
+
+	list_io_segments_t seg;
+	seg.fd          = fd;
+	seg.count       = 0;
+	seg.buffer_size = LIST_IO_BUFFER;
+	seg.buffer      = (char*) malloc(seg.buffer_size);
+	seg.used        = 0;
+	seg.gathered    = 0;
+	if (!seg.buffer)
+		return LIST_ALLOC_ERR;
+
+	// Chunk indexes are gathered into the buffer, so they are copied.
+	uint64_t     chunk_slots = LIST_CHUNK_SLOTS;
+	list_error_t err         = list_io_add_stretch(&seg, (char*) &header,
+	                                               sizeof header);
+	if (err == LIST_NO_ERR)
+		err = list_io_add_stretch(&seg, (char*) &chunk_slots,
+		                          sizeof chunk_slots);
+	if (err == LIST_NO_ERR)
+		err = list_io_add_stretch(&seg, (char*) &amount, sizeof amount);
+
+	for (size_t i = 0; i < chunks && err == LIST_NO_ERR; ++i)
+	{
+		if (!(lst->chunks[i / 8] >> (i % 8) & 1))
+			continue;
+
+		uint64_t index = i;
+		size_t   first = i * LIST_CHUNK_SLOTS;
+		size_t   slots = (first + LIST_CHUNK_SLOTS < lst->capacity)
+		                 ? LIST_CHUNK_SLOTS : lst->capacity - first;
+
+		err = list_io_add_stretch(&seg, (char*) &index, sizeof index);
+		if (err == LIST_NO_ERR)
+			err = list_io_add_stretch(&seg,
+			                          (char*) lst->data
+			                          + first * lst->elem_size,
+			                          slots * lst->elem_size);
+		if (err == LIST_NO_ERR)
+			err = list_io_add_stretch(&seg, (char*) (lst->nexts + first),
+			                          slots * sizeof *lst->nexts);
+		if (err == LIST_NO_ERR)
+			err = list_io_add_stretch(&seg, (char*) (lst->prevs + first),
+			                          slots * sizeof *lst->prevs);
+	}
+
+	if (err == LIST_NO_ERR)
+		err = list_io_flush_segments(&seg);
+	if (err == LIST_NO_ERR)
+		memset(lst->chunks, 0, LIST_CHUNKS_SIZE(lst->capacity));
+
+	free(seg.buffer);
+	return err;
+}
+
+
+list_error_t list_apply_checkpoint (list_t lst, int fd)
+{
+	assert (lst);
+
+	list_file_header_t header;
+	uint64_t           chunk_slots = 0;
+	uint64_t           amount      = 0;
+
+	list_error_t err = list_io_read(fd, &header, sizeof header);
+	if (err == LIST_NO_ERR)
+		err = list_io_read(fd, &chunk_slots, sizeof chunk_slots);
+	if (err == LIST_NO_ERR)
+		err = list_io_read(fd, &amount, sizeof amount);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	if (memcmp(header.magic, LIST_FILE_MAGIC, sizeof header.magic)
+	    || header.version    != LIST_FILE_VERSION
+	    || header.mode       != LIST_FILE_CHUNKS
+	    || header.index_size != sizeof (size_t)
+	    || header.elem_size  != lst->elem_size
+	    || !header.size || header.size > header.capacity
+	    || header.head >= header.capacity || header.tail >= header.capacity
+	    || header.first_free >= header.capacity
+	    || !chunk_slots)
+		return LIST_BAD_FORMAT;
+
+	// Kept slots are the same as in the previous checkpoint, new slots
+	// are in chunks of this one.
+	size_t capacity = (size_t) header.capacity;
+	err = list_resize_slots(lst, capacity - 1);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	for (uint64_t rec = 0; rec < amount; ++rec)
+	{
+		uint64_t index = 0;
+		err = list_io_read(fd, &index, sizeof index);
+		if (err != LIST_NO_ERR)
+			return err;
+
+		if (index >= (capacity + chunk_slots - 1) / chunk_slots)
+			return LIST_BAD_FORMAT;
+
+		size_t first = (size_t) (index * chunk_slots);
+		size_t slots = (first + chunk_slots < capacity)
+		               ? (size_t) chunk_slots : capacity - first;
+
+		err = list_io_read(fd, (char*) lst->data + first * lst->elem_size,
+		                   slots * lst->elem_size);
+		if (err == LIST_NO_ERR)
+			err = list_io_read(fd, lst->nexts + first,
+			                   slots * sizeof *lst->nexts);
+		if (err == LIST_NO_ERR)
+			err = list_io_read(fd, lst->prevs + first,
+			                   slots * sizeof *lst->prevs);
+		if (err != LIST_NO_ERR)
+			return err;
+
+		if (lst->dirty || lst->chunks)
+			for (size_t i = first; i < first + slots; ++i)
+				list_delta_touch(lst, i);
+	}
+
+	lst->size       = (size_t) header.size;
+	lst->first_free = (size_t) header.first_free;
+	lst->head       = (size_t) header.head;
+	lst->tail       = (size_t) header.tail;
+	lst->normalized = header.normalized;
+
+	return LIST_NO_ERR;
+}
+
+
+list_t list_load (int fd, void (*print_func) (const void*, FILE*))
+{
+	list_file_header_t header;
+	if (list_io_read(fd, &header, sizeof header) != LIST_NO_ERR
+	    || memcmp(header.magic, LIST_FILE_MAGIC, sizeof header.magic)
+	    || header.version    != LIST_FILE_VERSION
+	    || header.index_size != sizeof (size_t)
+	    || !header.elem_size || !header.size || !header.capacity)
+		return NULL;
+
+	switch (header.mode)
+	{
+		case LIST_SAVE_PAYLOAD:
+			return list_io_read_payload(fd, &header, print_func);
+
+		case LIST_SAVE_EXACT:
+			return list_io_read_exact(fd, &header, print_func);
+
+		case LIST_SAVE_COMPRESSED:
+			return list_io_read_compressed(fd, &header, print_func);
+
+		default:
+			return NULL;
+	}
+}
@@ -0,0 +1,135 @@
+/*!
+ * @brief Header file with saving and loading of doubly linked lists.
+ */
+
+
+#ifndef LIST_IO_H_
+#define LIST_IO_H_
+
+#include "list.h"
+
+
+
+
+/*!
+ * @brief Size of the buffer which is used to gather elements while saving.
+ */
+#define LIST_IO_BUFFER ((size_t) 1 << 20)
+
+/*!
+ * @brief Maximal amount of segments passed to one writev() call.
+ */
+#define LIST_IO_SEGMENTS 64
+
+/*!
+ * @brief Contiguous stretches of elements shorter than this amount of bytes
+ * are gathered into the buffer instead of being written directly.
+ */
+#define LIST_IO_SEGMENT_MIN ((size_t) 512)
+
+
+
+
+/*!
+ * @brief Ways to save a list.
+ */
+typedef enum
+{
+	LIST_SAVE_PAYLOAD = 0, /*!< save only elements in the list order.
+	                            Loaded list is normalized.                   */
+	LIST_SAVE_EXACT   = 1, /*!< save raw data, nexts and prevs arrays.
+	                            Loaded list has the same state.              */
+	LIST_SAVE_COMPRESSED = 3, /*!< save compressed nexts array and data
+	                               of elements in order of slots. Loaded
+	                               list has the same state.                  */
+}
+list_save_mode_t;
+
+
+
+
+/*!
+ * @brief Save list to file descriptor.
+ *
+ * Format is a versioned header followed by elements in the list order
+ * (LIST_SAVE_PAYLOAD), by raw arrays (LIST_SAVE_EXACT) or by compressed
+ * links and elements (LIST_SAVE_COMPRESSED). Compressed links are
+ * differences between nexts[i] and i + 1 as zigzag varints where runs
+ * of zero differences are replaced by their length. Prevs array and
+ * free slots are restored from links.
+ * Byte order and size of index are the same as in the running program.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_save
+(
+	const list_t     lst,  /*!< [in] list.                                   */
+	int              fd,   /*!< [in] file descriptor opened for writing.     */
+	list_save_mode_t mode  /*!< [in] way to save list.                       */
+);
+
+/*!
+ * @brief Write elements in the list order to file descriptor.
+ *
+ * Contiguous stretches of elements are written directly from the list
+ * using writev() (a single segment if the list is normalized). Only short
+ * stretches of fragmented list are gathered into a buffer.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_write_to_fd
+(
+	const list_t lst, /*!< [in] list.                                        */
+	int          fd   /*!< [in] file descriptor opened for writing.          */
+);
+
+/*!
+ * @brief Write chunks of the list changed since the last call.
+ *
+ * The list is divided into chunks of LIST_CHUNK_SLOTS slots. Every
+ * mutation marks chunks of changed slots. First call writes all chunks
+ * and starts tracking, next calls write only changed chunks (with data,
+ * nexts and prevs arrays) and fields of the list.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_checkpoint_incremental
+(
+	list_t lst, /*!< [in,out] list.                                          */
+	int    fd   /*!< [in]     file descriptor opened for writing.            */
+);
+
+/*!
+ * @brief Apply chunks written by list_checkpoint_incremental().
+ *
+ * Checkpoints must be applied in the order they were written starting
+ * from the first one, which can be applied to any list with the same
+ * size of element.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_apply_checkpoint
+(
+	list_t lst, /*!< [in,out] list.                                          */
+	int    fd   /*!< [in]     file descriptor opened for reading.            */
+);
+
+/*!
+ * @brief Load list saved by list_save().
+ *
+ * @note Don't forget to free memory using list_destroy() function.
+ *
+ * @return Loaded list or NULL if some error has been occurred.
+ */
+list_t list_load
+(
+	int fd,                                 /*!< [in] file descriptor opened
+	                                                  for reading.           */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+);
+
+
+
+
+#endif // undefined LIST_IO_H_
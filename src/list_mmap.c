@@ -0,0 +1,858 @@
+/*!
+ * @file Doubly linked lists placed in memory mapped files.
+ */
+
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "list_mmap.h"
+
+
+
+
+/*!
+ * @brief Magic number of list file.
+ */
+#define LIST_MMAP_MAGIC "LSTM"
+
+/*!
+ * @brief Version of list file format.
+ */
+#define LIST_MMAP_VERSION ((uint32_t) 1)
+
+/*!
+ * @brief Header of list file.
+ */
+typedef struct
+{
+	char     magic[4];   /*!< LIST_MMAP_MAGIC.                               */
+	uint32_t version;    /*!< LIST_MMAP_VERSION.                             */
+	uint64_t index_size; /*!< size of one element of nexts and prevs.        */
+	uint64_t elem_size;  /*!< size of one element.                           */
+	uint64_t size;       /*!< amount of elements including virtual one.      */
+	uint64_t capacity;   /*!< capacity including virtual element.            */
+	uint64_t first_free; /*!< index of first free element.                   */
+	uint64_t head;       /*!< head of the list.                              */
+	uint64_t tail;       /*!< tail of the list.                              */
+	uint64_t normalized; /*!< is list normalized.                            */
+	_Atomic uint64_t sequence; /*!< sequence of shared list. It is odd
+	                                while writer changes the list.           */
+}
+list_mmap_header_t;
+
+/*!
+ * @brief Context of memory mapped storage.
+ */
+typedef struct
+{
+	int    fd;        /*!< descriptor of list file.                          */
+	char*  path;      /*!< path to list file or NULL for shared memory.      */
+	size_t budget;    /*!< bytes of the file kept in memory while
+	                       the list is normalized.                           */
+	int    prot;      /*!< protection of mapping.                            */
+	bool   shared;    /*!< is list placed in shared memory.                  */
+	char*  map;       /*!< mapping of list file.                             */
+	size_t map_size;  /*!< size of mapping.                                  */
+	size_t file_size; /*!< size of list file.                                */
+}
+list_mmap_ctx_t;
+
+
+
+
+/*!
+ * @brief Get offset of nexts array in list file.
+ *
+ * @return Offset in bytes.
+ */
+static size_t list_mmap_nexts_offset
+(
+	size_t capacity, /*!< [in] capacity including virtual element.          */
+	size_t elem_size /*!< [in] size of one element.                         */
+)
+{
+	size_t data_size = capacity * elem_size;
+	return LIST_MMAP_HEADER_SIZE
+	       + (data_size + sizeof (size_t) - 1) / sizeof (size_t)
+	         * sizeof (size_t);
+}
+
+/*!
+ * @brief Get offset of prevs array in list file.
+ *
+ * @return Offset in bytes.
+ */
+static size_t list_mmap_prevs_offset
+(
+	size_t capacity, /*!< [in] capacity including virtual element.          */
+	size_t elem_size /*!< [in] size of one element.                         */
+)
+{
+	return list_mmap_nexts_offset(capacity, elem_size)
+	       + capacity * sizeof (size_t);
+}
+
+/*!
+ * @brief Get size of list file.
+ *
+ * @return Size in bytes.
+ */
+static size_t list_mmap_file_size
+(
+	size_t capacity, /*!< [in] capacity including virtual element.          */
+	size_t elem_size /*!< [in] size of one element.                         */
+)
+{
+	return list_mmap_prevs_offset(capacity, elem_size)
+	       + capacity * sizeof (size_t);
+}
+
+/*!
+ * @brief Check fields of the header in constant time: indexes must be
+ * less than capacity and size of file must fit in size_t.
+ *
+ * @return Are fields valid.
+ */
+static bool list_mmap_check_fields
+(
+	const list_mmap_header_t* header,   /*!< [in] header.                    */
+	uint64_t                  elem_size /*!< [in] size of one element.       */
+)
+{
+	uint64_t capacity = header->capacity;
+	uint64_t limit    = SIZE_MAX - LIST_MMAP_HEADER_SIZE - sizeof (size_t);
+
+	return capacity && elem_size && elem_size <= limit
+	       && capacity <= limit / (elem_size + 2 * sizeof (size_t))
+	       && header->size       && header->size <= capacity
+	       && header->head       <  capacity
+	       && header->tail       <  capacity
+	       && header->first_free <  capacity;
+}
+
+/*!
+ * @brief Point arrays of the list to the mapping.
+ */
+static void list_mmap_set_arrays
+(
+	list_t                 lst,     /*!< [in,out] list.                      */
+	const list_mmap_ctx_t* ctx,     /*!< [in]     context of storage.        */
+	size_t                 capacity /*!< [in]     capacity of arrays.        */
+)
+{
+	lst->data  = ctx->map + LIST_MMAP_HEADER_SIZE;
+	lst->nexts = (size_t*) (ctx->map
+	                        + list_mmap_nexts_offset(capacity, lst->elem_size));
+	lst->prevs = (size_t*) (ctx->map
+	                        + list_mmap_prevs_offset(capacity, lst->elem_size));
+}
+
+/*!
+ * @brief Change size of the mapping.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_mmap_remap
+(
+	list_mmap_ctx_t* ctx,     /*!< [in,out] context of storage.              */
+	size_t           new_size /*!< [in]     new size of the mapping.         */
+)
+{
+#ifdef MREMAP_MAYMOVE
+	void* map = mremap(ctx->map, ctx->map_size, new_size, MREMAP_MAYMOVE);
+#else
+	munmap(ctx->map, ctx->map_size);
+	void* map = mmap(NULL, new_size, ctx->prot, MAP_SHARED, ctx->fd, 0);
+#endif // defined MREMAP_MAYMOVE
+
+	if (map == MAP_FAILED)
+		return LIST_ALLOC_ERR;
+
+	ctx->map      = (char*) map;
+	ctx->map_size = new_size;
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Write fields of the list to the header of list file.
+ */
+static void list_mmap_fill_header
+(
+	const list_t lst, /*!< [in]  list.                                       */
+	char*        map  /*!< [out] mapping of list file.                       */
+)
+{
+	list_mmap_header_t* header = (list_mmap_header_t*) map;
+
+	memcpy(header->magic, LIST_MMAP_MAGIC, sizeof header->magic);
+	header->version    = LIST_MMAP_VERSION;
+	header->index_size = sizeof *lst->nexts;
+	header->elem_size  = lst->elem_size;
+	header->size       = lst->size;
+	header->capacity   = lst->capacity;
+	header->first_free = lst->first_free;
+	header->head       = lst->head;
+	header->tail       = lst->tail;
+	header->normalized = lst->normalized;
+}
+
+/*!
+ * @brief Write fields of the list to the header of its file.
+ */
+static void list_mmap_write_header
+(
+	const list_t lst /*!< [in] list.                                         */
+)
+{
+	list_mmap_fill_header(lst,
+	                      ((list_mmap_ctx_t*) lst->storage_ctx)->map);
+}
+
+/*!
+ * @brief Change capacity of arrays placed in the mapping.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_mmap_resize (list_t lst, size_t new_capacity)
+{
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) lst->storage_ctx;
+
+	size_t old_nexts = list_mmap_nexts_offset(lst->capacity, lst->elem_size);
+	size_t old_prevs = list_mmap_prevs_offset(lst->capacity, lst->elem_size);
+	size_t new_nexts = list_mmap_nexts_offset(new_capacity,  lst->elem_size);
+	size_t new_prevs = list_mmap_prevs_offset(new_capacity,  lst->elem_size);
+	size_t new_size  = list_mmap_file_size(new_capacity,     lst->elem_size);
+
+	if (new_capacity > lst->capacity)
+	{
+		if (new_size > ctx->file_size)
+		{
+			if (ftruncate(ctx->fd, (off_t) new_size))
+				return LIST_ALLOC_ERR;
+			ctx->file_size = new_size;
+		}
+
+		list_error_t err = list_mmap_remap(ctx, new_size);
+		if (err != LIST_NO_ERR)
+			return err;
+
+		memmove(ctx->map + new_prevs, ctx->map + old_prevs,
+		        lst->capacity * sizeof *lst->prevs);
+		memmove(ctx->map + new_nexts, ctx->map + old_nexts,
+		        lst->capacity * sizeof *lst->nexts);
+	}
+	else
+	{
+		memmove(ctx->map + new_nexts, ctx->map + old_nexts,
+		        new_capacity * sizeof *lst->nexts);
+		memmove(ctx->map + new_prevs, ctx->map + old_prevs,
+		        new_capacity * sizeof *lst->prevs);
+
+		list_error_t err = list_mmap_remap(ctx, new_size);
+		if (err != LIST_NO_ERR)
+			return err;
+
+		// Readers of shared list may still access the tail of the object.
+		if (!ctx->shared)
+		{
+			if (ftruncate(ctx->fd, (off_t) new_size))
+				return LIST_IO_ERR;
+			ctx->file_size = new_size;
+		}
+	}
+
+	list_mmap_set_arrays(lst, ctx, new_capacity);
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Write header, unmap and close list file.
+ */
+static void list_mmap_release (list_t lst)
+{
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) lst->storage_ctx;
+
+	list_mmap_write_header(lst);
+	munmap(ctx->map, ctx->map_size);
+	close(ctx->fd);
+	free(ctx->path);
+	free(ctx);
+
+	lst->data        = NULL;
+	lst->nexts       = NULL;
+	lst->prevs       = NULL;
+	lst->storage_ctx = NULL;
+}
+
+/*!
+ * @brief Write and drop from memory written part of the mapping.
+ */
+static void list_mmap_drop
+(
+	int    fd,    /*!< [in] file descriptor.                                 */
+	char*  map,   /*!< [in] mapping of the file.                             */
+	size_t from,  /*!< [in] first byte of written part.                      */
+	size_t to     /*!< [in] end of written part.                             */
+)
+{
+	size_t page = (size_t) sysconf(_SC_PAGESIZE);
+
+	from = from / page * page;
+	to   = to   / page * page;
+	if (from >= to)
+		return;
+
+	msync(map + from, to - from, MS_SYNC);
+	madvise(map + from, to - from, MADV_DONTNEED);
+	posix_fadvise(fd, (off_t) from, (off_t) (to - from), POSIX_FADV_DONTNEED);
+}
+
+/*!
+ * @brief Normalize the list by streaming its elements in the list order
+ * into new file which replaces the old one.
+ *
+ * Elements are read once in the list order and written sequentially.
+ * Written part of new file is dropped from memory every budget bytes.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_mmap_normalize (list_t lst)
+{
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) lst->storage_ctx;
+	if (!ctx->path)
+		return LIST_BAD_MEMORY;
+
+	size_t path_len = strlen(ctx->path);
+	char*  tmp_path = (char*) malloc(path_len + sizeof ".tmp");
+	if (!tmp_path)
+		return LIST_ALLOC_ERR;
+	memcpy(tmp_path, ctx->path, path_len);
+	memcpy(tmp_path + path_len, ".tmp", sizeof ".tmp");
+
+	size_t map_size = list_mmap_file_size(lst->capacity, lst->elem_size);
+	int    fd       = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	void*  map      = (fd < 0 || ftruncate(fd, (off_t) map_size))
+	                  ? MAP_FAILED
+	                  : mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+	                         MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+			unlink(tmp_path);
+		}
+		free(tmp_path);
+		return LIST_IO_ERR;
+	}
+
+	char*   data  = (char*) map + LIST_MMAP_HEADER_SIZE;
+	size_t* nexts = (size_t*) ((char*) map
+	                           + list_mmap_nexts_offset(lst->capacity,
+	                                                    lst->elem_size));
+	size_t* prevs = (size_t*) ((char*) map
+	                           + list_mmap_prevs_offset(lst->capacity,
+	                                                    lst->elem_size));
+
+	madvise(lst->data, lst->capacity * lst->elem_size, MADV_RANDOM);
+	madvise(data, lst->capacity * lst->elem_size, MADV_SEQUENTIAL);
+
+	size_t          dropped = LIST_MMAP_HEADER_SIZE;
+	list_iterator_t it      = lst->head;
+	for (size_t i = 1; i < lst->size; ++i)
+	{
+		memcpy(data + i * lst->elem_size,
+		       (char*) lst->data + it * lst->elem_size, lst->elem_size);
+		it = lst->nexts[it];
+
+		size_t written = LIST_MMAP_HEADER_SIZE + (i + 1) * lst->elem_size;
+		if (written - dropped >= ctx->budget)
+		{
+			list_mmap_drop(fd, (char*) map, dropped, written);
+			dropped = written;
+		}
+	}
+
+	for (size_t i = 0; i < lst->size; ++i)
+	{
+		nexts[i] = (i + 1) % lst->size;
+		prevs[i] = (i + lst->size - 1) % lst->size;
+	}
+	for (size_t i = lst->size; i < lst->capacity; ++i)
+	{
+		nexts[i] = (i + 1) % lst->capacity;
+		prevs[i] = i;
+	}
+
+	struct list_t_ normalized = *lst;
+	normalized.head       = (lst->size > 1) ? 1 : 0;
+	normalized.tail       = lst->size - 1;
+	normalized.first_free = (lst->size < lst->capacity) ? lst->size : 0;
+	normalized.normalized = true;
+	list_mmap_fill_header(&normalized, (char*) map);
+
+	if (msync(map, map_size, MS_SYNC) || rename(tmp_path, ctx->path))
+	{
+		munmap(map, map_size);
+		close(fd);
+		unlink(tmp_path);
+		free(tmp_path);
+		return LIST_IO_ERR;
+	}
+	free(tmp_path);
+
+	munmap(ctx->map, ctx->map_size);
+	close(ctx->fd);
+
+	ctx->fd        = fd;
+	ctx->map       = (char*) map;
+	ctx->map_size  = map_size;
+	ctx->file_size = map_size;
+
+	lst->head       = normalized.head;
+	lst->tail       = normalized.tail;
+	lst->first_free = normalized.first_free;
+	lst->normalized = true;
+	list_mmap_set_arrays(lst, ctx, lst->capacity);
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Storage which places arrays of the list in memory mapped file.
+ */
+static const list_storage_t LIST_MMAP_STORAGE =
+{
+	list_mmap_resize,
+	list_mmap_release,
+	list_mmap_normalize,
+};
+
+/*!
+ * @brief Refuse to change capacity of attached shared list.
+ *
+ * @return LIST_ALLOC_ERR.
+ */
+static list_error_t list_shm_reader_resize (list_t lst, size_t new_capacity)
+{
+	(void) lst;
+	(void) new_capacity;
+
+	return LIST_ALLOC_ERR;
+}
+
+/*!
+ * @brief Unmap and close attached shared list.
+ */
+static void list_shm_reader_release (list_t lst)
+{
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) lst->storage_ctx;
+
+	munmap(ctx->map, ctx->map_size);
+	close(ctx->fd);
+	free(ctx);
+
+	lst->data        = NULL;
+	lst->nexts       = NULL;
+	lst->prevs       = NULL;
+	lst->storage_ctx = NULL;
+}
+
+/*!
+ * @brief Read only storage of list attached to shared memory.
+ */
+static const list_storage_t LIST_SHM_READER_STORAGE =
+{
+	list_shm_reader_resize,
+	list_shm_reader_release,
+	NULL,
+};
+
+/*!
+ * @brief Replace heap arrays of just created list by mapping of the file.
+ */
+static void list_mmap_attach
+(
+	list_t                lst,     /*!< [in,out] list.                       */
+	list_mmap_ctx_t*      ctx,     /*!< [in]     context of storage.         */
+	const list_storage_t* storage  /*!< [in]     storage.                    */
+)
+{
+	free(lst->data);
+	free(lst->nexts);
+	free(lst->prevs);
+
+	lst->storage     = storage;
+	lst->storage_ctx = ctx;
+}
+
+/*!
+ * @brief Create new list in the file opened for reading and writing.
+ *
+ * @note File descriptor is closed on failure.
+ *
+ * @return List which was created. If some error has been occurred
+ * it returns NULL.
+ */
+static list_t list_mmap_create_fd
+(
+	int         fd,                          /*!< [in] file descriptor.      */
+	const char* path,                        /*!< [in] path to file or NULL
+	                                                   for shared memory.    */
+	size_t start_capacity,                   /*!< [in] start capacity of
+	                                                   creating list.        */
+	void (*print_func) (const void*, FILE*), /*!< [in] function which prints
+	                                                   one list element.     */
+	size_t elem_size                         /*!< [in] size of one element
+	                                                   in creating list.     */
+)
+{
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) calloc(1, sizeof *ctx);
+	list_t           lst = list_create_func_(0, print_func, elem_size);
+	char*            dup = (path) ? strdup(path) : NULL;
+	if (!ctx || !lst || (path && !dup))
+	{
+		close(fd);
+		free(ctx);
+		free(dup);
+		return list_destroy(lst);
+	}
+
+	ctx->fd        = fd;
+	ctx->path      = dup;
+	ctx->budget    = LIST_MMAP_BUDGET;
+	ctx->prot      = PROT_READ | PROT_WRITE;
+	ctx->shared    = !path;
+	ctx->map_size  = list_mmap_file_size(lst->capacity, elem_size);
+	ctx->file_size = ctx->map_size;
+
+	void* map = (ftruncate(fd, (off_t) ctx->map_size))
+	            ? MAP_FAILED
+	            : mmap(NULL, ctx->map_size, ctx->prot, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		close(fd);
+		free(ctx->path);
+		free(ctx);
+		return list_destroy(lst);
+	}
+	ctx->map = (char*) map;
+
+	// Zeroed file has the same state as just created empty list.
+	list_mmap_attach(lst, ctx, &LIST_MMAP_STORAGE);
+	list_mmap_set_arrays(lst, ctx, lst->capacity);
+	list_mmap_write_header(lst);
+
+	if (start_capacity
+	    && list_change_capacity(lst, start_capacity) != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	return lst;
+}
+
+
+
+
+list_t list_mmap_create_func_ (const char* path, size_t start_capacity,
+                               void (*print_func) (const void*, FILE*),
+                               size_t elem_size)
+{
+	assert (path);
+
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return NULL;
+
+	return list_mmap_create_fd(fd, path, start_capacity, print_func,
+	                           elem_size);
+}
+
+
+list_t list_mmap_open (const char* path,
+                       void (*print_func) (const void*, FILE*))
+{
+	assert (path);
+
+	int fd = open(path, O_RDWR);
+	if (fd < 0)
+		return NULL;
+
+	list_mmap_header_t header;
+	struct stat        st;
+	if (pread(fd, &header, sizeof header, 0) != (ssize_t) sizeof header
+	    || memcmp(header.magic, LIST_MMAP_MAGIC, sizeof header.magic)
+	    || header.version    != LIST_MMAP_VERSION
+	    || header.index_size != sizeof (size_t)
+	    || !list_mmap_check_fields(&header, header.elem_size)
+	    || fstat(fd, &st)
+	    || (size_t) st.st_size < list_mmap_file_size((size_t) header.capacity,
+	                                                 (size_t) header.elem_size))
+	{
+		close(fd);
+		return NULL;
+	}
+
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) calloc(1, sizeof *ctx);
+	list_t           lst = list_create_func_(0, print_func,
+	                                         (size_t) header.elem_size);
+	char*            dup = strdup(path);
+	if (!ctx || !lst || !dup)
+	{
+		close(fd);
+		free(ctx);
+		free(dup);
+		return list_destroy(lst);
+	}
+
+	ctx->fd        = fd;
+	ctx->path      = dup;
+	ctx->budget    = LIST_MMAP_BUDGET;
+	ctx->prot      = PROT_READ | PROT_WRITE;
+	ctx->map_size  = list_mmap_file_size((size_t) header.capacity,
+	                                     (size_t) header.elem_size);
+	ctx->file_size = ctx->map_size;
+
+	void* map = mmap(NULL, ctx->map_size, ctx->prot, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		close(fd);
+		free(ctx->path);
+		free(ctx);
+		return list_destroy(lst);
+	}
+	ctx->map = (char*) map;
+
+	list_mmap_attach(lst, ctx, &LIST_MMAP_STORAGE);
+
+	lst->size       = (size_t) header.size;
+	lst->capacity   = (size_t) header.capacity;
+	lst->first_free = (size_t) header.first_free;
+	lst->head       = (size_t) header.head;
+	lst->tail       = (size_t) header.tail;
+	lst->normalized = header.normalized;
+	list_mmap_set_arrays(lst, ctx, lst->capacity);
+
+	return lst;
+}
+
+
+list_error_t list_mmap_sync (const list_t lst)
+{
+	assert (lst);
+	assert (lst->storage == &LIST_MMAP_STORAGE);
+
+	list_mmap_ctx_t* ctx = (list_mmap_ctx_t*) lst->storage_ctx;
+
+	list_mmap_write_header(lst);
+	if (msync(ctx->map, ctx->map_size, MS_SYNC))
+		return LIST_IO_ERR;
+
+	return LIST_NO_ERR;
+}
+
+
+void list_mmap_set_budget (list_t lst, size_t budget)
+{
+	assert (lst);
+	assert (lst->storage == &LIST_MMAP_STORAGE);
+
+	((list_mmap_ctx_t*) lst->storage_ctx)->budget = (budget) ? budget : 1;
+}
+
+
+list_t list_shm_create_func_ (const char* name, size_t start_capacity,
+                              void (*print_func) (const void*, FILE*),
+                              size_t elem_size)
+{
+	assert (name);
+
+	// Truncation of object which is mapped by readers would make their
+	// mappings invalid, so old object is unlinked and new one is created.
+	if (shm_unlink(name) && errno != ENOENT)
+		return NULL;
+
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0)
+		return NULL;
+
+	list_t lst = list_mmap_create_fd(fd, NULL, start_capacity, print_func,
+	                                 elem_size);
+	if (!lst)
+		shm_unlink(name);
+
+	return lst;
+}
+
+
+list_t list_shm_attach (const char* name,
+                        void (*print_func) (const void*, FILE*))
+{
+	assert (name);
+
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	void*       map = MAP_FAILED;
+	if (!fstat(fd, &st) && (size_t) st.st_size >= LIST_MMAP_HEADER_SIZE)
+		map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	const list_mmap_header_t* header = (const list_mmap_header_t*) map;
+
+	list_mmap_ctx_t* ctx = NULL;
+	list_t           lst = NULL;
+	if (!memcmp(header->magic, LIST_MMAP_MAGIC, sizeof header->magic)
+	    && header->version    == LIST_MMAP_VERSION
+	    && header->index_size == sizeof (size_t)
+	    && header->elem_size)
+	{
+		ctx = (list_mmap_ctx_t*) calloc(1, sizeof *ctx);
+		lst = list_create_func_(0, print_func, (size_t) header->elem_size);
+	}
+	if (!ctx || !lst)
+	{
+		munmap(map, (size_t) st.st_size);
+		close(fd);
+		free(ctx);
+		return list_destroy(lst);
+	}
+
+	ctx->fd        = fd;
+	ctx->prot      = PROT_READ;
+	ctx->shared    = true;
+	ctx->map       = (char*) map;
+	ctx->map_size  = (size_t) st.st_size;
+	ctx->file_size = ctx->map_size;
+	list_mmap_attach(lst, ctx, &LIST_SHM_READER_STORAGE);
+
+	size_t sequence = 0;
+	if (list_shm_read_begin(lst, &sequence) != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	return lst;
+}
+
+
+void list_shm_write_begin (list_t lst)
+{
+	assert (lst);
+	assert (lst->storage == &LIST_MMAP_STORAGE);
+	assert (((list_mmap_ctx_t*) lst->storage_ctx)->shared);
+
+	list_mmap_ctx_t*    ctx    = (list_mmap_ctx_t*) lst->storage_ctx;
+	list_mmap_header_t* header = (list_mmap_header_t*) ctx->map;
+
+	uint64_t sequence = atomic_load_explicit(&header->sequence,
+	                                         memory_order_relaxed);
+	atomic_store_explicit(&header->sequence, sequence + 1,
+	                      memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+
+void list_shm_write_end (list_t lst)
+{
+	assert (lst);
+	assert (lst->storage == &LIST_MMAP_STORAGE);
+	assert (((list_mmap_ctx_t*) lst->storage_ctx)->shared);
+
+	list_mmap_ctx_t*    ctx    = (list_mmap_ctx_t*) lst->storage_ctx;
+	list_mmap_header_t* header = (list_mmap_header_t*) ctx->map;
+
+	list_mmap_write_header(lst);
+
+	uint64_t sequence = atomic_load_explicit(&header->sequence,
+	                                         memory_order_relaxed);
+	atomic_store_explicit(&header->sequence, sequence + 1,
+	                      memory_order_release);
+}
+
+
+list_error_t list_shm_read_begin (list_t lst, size_t* sequence)
+{
+	assert (lst);
+	assert (sequence);
+	assert (lst->storage == &LIST_SHM_READER_STORAGE);
+
+	list_mmap_ctx_t*          ctx    = (list_mmap_ctx_t*) lst->storage_ctx;
+	const list_mmap_header_t* header = (const list_mmap_header_t*) ctx->map;
+
+	list_mmap_header_t fields;
+	uint64_t           begin = 0;
+	for (;;)
+	{
+		begin = atomic_load_explicit(&header->sequence, memory_order_acquire);
+		if (begin % 2)
+		{
+			sched_yield();
+			continue;
+		}
+
+		fields.size       = header->size;
+		fields.capacity   = header->capacity;
+		fields.first_free = header->first_free;
+		fields.head       = header->head;
+		fields.tail       = header->tail;
+		fields.normalized = header->normalized;
+
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&header->sequence, memory_order_relaxed)
+		    == begin)
+			break;
+	}
+
+	if (!list_mmap_check_fields(&fields, lst->elem_size))
+		return LIST_BAD_FORMAT;
+
+	size_t map_size = list_mmap_file_size((size_t) fields.capacity,
+	                                      lst->elem_size);
+	if (map_size > ctx->map_size)
+	{
+		list_error_t err = list_mmap_remap(ctx, map_size);
+		if (err != LIST_NO_ERR)
+			return err;
+	}
+
+	lst->size       = (size_t) fields.size;
+	lst->capacity   = (size_t) fields.capacity;
+	lst->first_free = (size_t) fields.first_free;
+	lst->head       = (size_t) fields.head;
+	lst->tail       = (size_t) fields.tail;
+	lst->normalized = fields.normalized;
+	list_mmap_set_arrays(lst, ctx, lst->capacity);
+
+	*sequence = (size_t) begin;
+	return LIST_NO_ERR;
+}
+
+
+bool list_shm_read_retry (const list_t lst, size_t sequence)
+{
+	assert (lst);
+	assert (lst->storage == &LIST_SHM_READER_STORAGE);
+
+	const list_mmap_ctx_t*    ctx    = (const list_mmap_ctx_t*)
+	                                   lst->storage_ctx;
+	const list_mmap_header_t* header = (const list_mmap_header_t*) ctx->map;
+
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&header->sequence, memory_order_relaxed)
+	       != (uint64_t) sequence;
+}
@@ -0,0 +1,216 @@
+/*!
+ * @brief Header file with doubly linked lists placed in memory mapped files.
+ */
+
+
+#ifndef LIST_MMAP_H_
+#define LIST_MMAP_H_
+
+#include "list.h"
+
+
+
+
+/*!
+ * @brief Size of the file header. Arrays of the list start after it.
+ */
+#define LIST_MMAP_HEADER_SIZE ((size_t) 4096)
+
+/*!
+ * @brief Default amount of bytes of the list file which are kept
+ * in memory while the list is normalized.
+ */
+#define LIST_MMAP_BUDGET ((size_t) 64 << 20)
+
+
+
+
+/*!
+ * @brief Create new list placed in memory mapped file.
+ *
+ * @note Don't forget to close file using list_destroy() function.
+ */
+#define list_mmap_create(PATH_, START_CAPACITY_, PRINT_FUNC_, TYPE_)          \
+	list_mmap_create_func_((PATH_), (START_CAPACITY_), (PRINT_FUNC_),         \
+	                       sizeof (TYPE_))
+
+/*!
+ * @brief Create new list placed in memory mapped file.
+ *
+ * File contains a header with fields of the list followed by data,
+ * nexts and prevs arrays. Because elements are linked by indexes
+ * the file can be mapped at any address. Existing file is truncated.
+ * Growth of the list extends the file.
+ *
+ * @note Use list_mmap_create() macro instead of this function.
+ *
+ * @return List which was created. If some error has been occurred
+ * it returns NULL.
+ */
+list_t list_mmap_create_func_
+(
+	const char* path,                        /*!< [in] path to file.         */
+	size_t start_capacity,                   /*!< [in] start capacity of
+	                                                   creating list.        */
+	void (*print_func) (const void*, FILE*), /*!< [in] function which prints
+	                                                   one list element.     */
+	size_t elem_size                         /*!< [in] size of one element
+	                                                   in creating list.     */
+);
+
+/*!
+ * @brief Open list placed in memory mapped file.
+ *
+ * File is mapped without reading or verifying its elements so it takes
+ * constant time.
+ *
+ * @note Don't forget to close file using list_destroy() function.
+ *
+ * @return Opened list. If some error has been occurred it returns NULL.
+ */
+list_t list_mmap_open
+(
+	const char* path,                       /*!< [in] path to file.          */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+);
+
+/*!
+ * @brief Write fields of the list to the file header and flush
+ * the mapping to the file.
+ *
+ * Header is also written when list is destroyed.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_mmap_sync
+(
+	const list_t lst /*!< [in] list placed in memory mapped file.            */
+);
+
+
+/*!
+ * @brief Set amount of bytes of the list file which are kept in memory
+ * while the list is normalized.
+ *
+ * list_normalize() of the list placed in file doesn't move elements
+ * in place. It streams them in the list order into a new file replacing
+ * the old one, so every element is read and written once. Written part
+ * of new file is flushed and dropped from memory every budget bytes.
+ * Other pages of the list are cached by the kernel.
+ */
+void list_mmap_set_budget
+(
+	list_t lst,   /*!< [in,out] list placed in memory mapped file.           */
+	size_t budget /*!< [in]     amount of bytes.                             */
+);
+
+/*!
+ * @brief Create new list placed in POSIX shared memory object.
+ *
+ * @note Don't forget to close object using list_destroy() function.
+ */
+#define list_shm_create(NAME_, START_CAPACITY_, PRINT_FUNC_, TYPE_)           \
+	list_shm_create_func_((NAME_), (START_CAPACITY_), (PRINT_FUNC_),          \
+	                      sizeof (TYPE_))
+
+/*!
+ * @brief Create new list placed in POSIX shared memory object.
+ *
+ * Object has the same layout as file of list_mmap_create(). The creating
+ * process is the only writer. It must change the list between
+ * list_shm_write_begin() and list_shm_write_end() calls. Other processes
+ * attach the list using list_shm_attach(). Object is not shrunk, so readers
+ * never access unmapped memory. Remove the object by shm_unlink().
+ *
+ * Existing object with the same name is unlinked and new one is created,
+ * so readers attached to the old object keep reading it. They must
+ * re-attach by list_shm_attach() after the writer has recreated the list.
+ *
+ * @note Use list_shm_create() macro instead of this function.
+ *
+ * @return List which was created. If some error has been occurred
+ * it returns NULL.
+ */
+list_t list_shm_create_func_
+(
+	const char* name,                        /*!< [in] name of shared memory
+	                                                   object.               */
+	size_t start_capacity,                   /*!< [in] start capacity of
+	                                                   creating list.        */
+	void (*print_func) (const void*, FILE*), /*!< [in] function which prints
+	                                                   one list element.     */
+	size_t elem_size                         /*!< [in] size of one element
+	                                                   in creating list.     */
+);
+
+/*!
+ * @brief Attach list placed in shared memory object for reading.
+ *
+ * Attached list can't be changed. Read it between list_shm_read_begin()
+ * and list_shm_read_retry() calls.
+ *
+ * @note Don't forget to detach using list_destroy() function.
+ *
+ * @return Attached list. If some error has been occurred it returns NULL.
+ */
+list_t list_shm_attach
+(
+	const char* name,                       /*!< [in] name of shared memory
+	                                                  object.                */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+);
+
+/*!
+ * @brief Start changing of shared list. Readers will retry reading
+ * until list_shm_write_end() is called.
+ */
+void list_shm_write_begin
+(
+	list_t lst /*!< [in,out] list created by list_shm_create().              */
+);
+
+/*!
+ * @brief Publish fields of shared list and finish changing of it.
+ */
+void list_shm_write_end
+(
+	list_t lst /*!< [in,out] list created by list_shm_create().              */
+);
+
+/*!
+ * @brief Start reading of attached list.
+ *
+ * Waits while writer changes the list, then updates fields of the list
+ * and remaps the object if it has grown.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_shm_read_begin
+(
+	list_t  lst,     /*!< [in,out] list attached by list_shm_attach().       */
+	size_t* sequence /*!< [out]    sequence to pass to list_shm_read_retry().*/
+);
+
+/*!
+ * @brief Check that list has been changed since list_shm_read_begin().
+ *
+ * Elements and iterators which have been read are valid only if this
+ * function returns false, otherwise reading must be repeated. Iterators
+ * got while writer changes the list can be wrong. Functions of list.h
+ * check them against capacity but list_verify() asserts fail on such list,
+ * so build readers with NDEBUG.
+ *
+ * @return Must reading be repeated.
+ */
+bool list_shm_read_retry
+(
+	const list_t lst,     /*!< [in] list attached by list_shm_attach().      */
+	size_t       sequence /*!< [in] sequence got by list_shm_read_begin().   */
+);
+
+
+
+
+#endif // undefined LIST_MMAP_H_
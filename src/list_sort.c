@@ -0,0 +1,496 @@
+/*!
+ * @file External sort of doubly linked lists.
+ */
+
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <unistd.h>
+
+#include "list_sort.h"
+
+
+
+
+/*!
+ * @brief Sorted run in temporary file.
+ */
+typedef struct
+{
+	off_t  offset; /*!< offset of the first element which isn't read.        */
+	size_t left;   /*!< amount of elements which aren't read.                */
+}
+list_sort_run_t;
+
+/*!
+ * @brief Run which is being merged.
+ */
+typedef struct
+{
+	list_sort_run_t run;      /*!< rest of the run.                          */
+	char*           buffer;   /*!< read elements.                            */
+	size_t          pos;      /*!< index of current element in buffer.       */
+	size_t          amount;   /*!< amount of elements in buffer.             */
+	size_t          capacity; /*!< capacity of buffer in elements.           */
+}
+list_sort_reader_t;
+
+/*!
+ * @brief State of k-way merging.
+ */
+typedef struct
+{
+	int                 fd;        /*!< temporary file.                      */
+	size_t              elem_size; /*!< size of one element.                 */
+	int               (*cmp) (const void*, const void*); /*!< comparator.    */
+	list_sort_reader_t* readers;   /*!< merged runs.                         */
+	size_t*             heap;      /*!< indexes of readers ordered by
+	                                    their current elements.              */
+	size_t              amount;    /*!< amount of readers in heap.           */
+}
+list_sort_merge_t;
+
+
+
+
+/*!
+ * @brief Write whole buffer to file at offset.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_sort_write
+(
+	int         fd,     /*!< [in] file descriptor.                           */
+	const void* buf,    /*!< [in] buffer.                                    */
+	size_t      size,   /*!< [in] size of buffer.                            */
+	off_t       offset  /*!< [in] offset in file.                            */
+)
+{
+	const char* ptr = (const char*) buf;
+	while (size)
+	{
+		ssize_t written = pwrite(fd, ptr, size, offset);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return LIST_IO_ERR;
+
+		ptr    += written;
+		offset += written;
+		size   -= (size_t) written;
+	}
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Read whole buffer from file at offset.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_sort_read
+(
+	int    fd,     /*!< [in]  file descriptor.                               */
+	void*  buf,    /*!< [out] buffer.                                        */
+	size_t size,   /*!< [in]  size of buffer.                                */
+	off_t  offset  /*!< [in]  offset in file.                                */
+)
+{
+	char* ptr = (char*) buf;
+	while (size)
+	{
+		ssize_t got = pread(fd, ptr, size, offset);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return LIST_IO_ERR;
+
+		ptr    += got;
+		offset += got;
+		size   -= (size_t) got;
+	}
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Open temporary file which is removed when it is closed.
+ *
+ * @return File descriptor or -1 if some error has been occurred.
+ */
+static int list_sort_open_tmp
+(
+	const char* tmp_dir /*!< [in] directory for temporary file.              */
+)
+{
+	static const char name[] = "/list_sort_XXXXXX";
+
+	size_t dir_len = strlen(tmp_dir);
+	char*  path    = (char*) malloc(dir_len + sizeof name);
+	if (!path)
+		return -1;
+	memcpy(path, tmp_dir, dir_len);
+	memcpy(path + dir_len, name, sizeof name);
+
+	int fd = mkstemp(path);
+	if (fd >= 0)
+		unlink(path);
+
+	free(path);
+	return fd;
+}
+
+/*!
+ * @brief Get current element of the reader.
+ *
+ * @return Pointer to element.
+ */
+static const char* list_sort_current
+(
+	const list_sort_merge_t* merge, /*!< [in] state of merging.              */
+	size_t                   index  /*!< [in] index of reader.               */
+)
+{
+	const list_sort_reader_t* reader = merge->readers + index;
+	return reader->buffer + reader->pos * merge->elem_size;
+}
+
+/*!
+ * @brief Move reader to the next element reading next block of the run
+ * if it is needed.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_sort_advance
+(
+	list_sort_merge_t*  merge,  /*!< [in]     state of merging.              */
+	list_sort_reader_t* reader  /*!< [in,out] reader.                        */
+)
+{
+	if (++reader->pos < reader->amount || !reader->run.left)
+		return LIST_NO_ERR;
+
+	size_t amount = (reader->run.left < reader->capacity)
+	                ? reader->run.left : reader->capacity;
+
+	list_error_t err = list_sort_read(merge->fd, reader->buffer,
+	                                  amount * merge->elem_size,
+	                                  reader->run.offset);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	reader->run.offset += (off_t) (amount * merge->elem_size);
+	reader->run.left   -= amount;
+	reader->pos         = 0;
+	reader->amount      = amount;
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Restore heap order moving element down from position.
+ */
+static void list_sort_sift_down
+(
+	list_sort_merge_t* merge, /*!< [in,out] state of merging.                */
+	size_t             pos    /*!< [in]     position in heap.                */
+)
+{
+	for (;;)
+	{
+		size_t least = pos;
+		size_t left  = 2 * pos + 1;
+		size_t right = 2 * pos + 2;
+
+		if (left < merge->amount
+		    && merge->cmp(list_sort_current(merge, merge->heap[left]),
+		                  list_sort_current(merge, merge->heap[least])) < 0)
+			least = left;
+		if (right < merge->amount
+		    && merge->cmp(list_sort_current(merge, merge->heap[right]),
+		                  list_sort_current(merge, merge->heap[least])) < 0)
+			least = right;
+
+		if (least == pos)
+			return;
+
+		size_t tmp         = merge->heap[pos];
+		merge->heap[pos]   = merge->heap[least];
+		merge->heap[least] = tmp;
+		pos                = least;
+	}
+}
+
+/*!
+ * @brief Merge runs calling output function for every element
+ * in sorted order.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_sort_merge
+(
+	list_sort_merge_t*     merge,   /*!< [in,out] state of merging.          */
+	const list_sort_run_t* runs,    /*!< [in]     merged runs.               */
+	size_t                 amount,  /*!< [in]     amount of runs.            */
+	list_error_t (*output) (void*, const void*), /*!< [in] function which
+	                                                  receives element.      */
+	void*                  ctx      /*!< [in]     context of output.         */
+)
+{
+	list_error_t err = LIST_NO_ERR;
+
+	merge->amount = 0;
+	for (size_t i = 0; i < amount && err == LIST_NO_ERR; ++i)
+	{
+		list_sort_reader_t* reader = merge->readers + i;
+
+		// Position before the first element makes advance read first block.
+		reader->run    = runs[i];
+		reader->pos    = (size_t) -1;
+		reader->amount = 0;
+
+		err = list_sort_advance(merge, reader);
+		if (reader->amount)
+			merge->heap[merge->amount++] = i;
+	}
+
+	for (size_t i = merge->amount; i-- > 0; )
+		list_sort_sift_down(merge, i);
+
+	while (merge->amount && err == LIST_NO_ERR)
+	{
+		size_t              top    = merge->heap[0];
+		list_sort_reader_t* reader = merge->readers + top;
+
+		err = output(ctx, list_sort_current(merge, top));
+		if (err == LIST_NO_ERR)
+			err = list_sort_advance(merge, reader);
+
+		if (reader->pos >= reader->amount)
+			merge->heap[0] = merge->heap[--merge->amount];
+
+		list_sort_sift_down(merge, 0);
+	}
+
+	return err;
+}
+
+/*!
+ * @brief Output of merging into temporary file.
+ */
+typedef struct
+{
+	int    fd;          /*!< temporary file.                                 */
+	char*  buffer;      /*!< buffer of written elements.                     */
+	size_t used;        /*!< amount of elements in buffer.                   */
+	size_t capacity;    /*!< capacity of buffer in elements.                 */
+	size_t elem_size;   /*!< size of one element.                            */
+	off_t  offset;      /*!< offset where buffer is written.                 */
+}
+list_sort_writer_t;
+
+/*!
+ * @brief Write buffered elements to temporary file.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_sort_flush
+(
+	list_sort_writer_t* writer /*!< [in,out] output.                         */
+)
+{
+	list_error_t err = list_sort_write(writer->fd, writer->buffer,
+	                                   writer->used * writer->elem_size,
+	                                   writer->offset);
+
+	writer->offset += (off_t) (writer->used * writer->elem_size);
+	writer->used    = 0;
+	return err;
+}
+
+/*!
+ * @brief Append element to temporary file.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_sort_to_file
+(
+	void*       ctx,  /*!< [in,out] list_sort_writer_t.                      */
+	const void* elem  /*!< [in]     element.                                 */
+)
+{
+	list_sort_writer_t* writer = (list_sort_writer_t*) ctx;
+
+	memcpy(writer->buffer + writer->used * writer->elem_size, elem,
+	       writer->elem_size);
+	if (++writer->used == writer->capacity)
+		return list_sort_flush(writer);
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Output of merging into normalized list.
+ */
+typedef struct
+{
+	list_t lst;  /*!< sorted list.                                           */
+	size_t next; /*!< slot of the next element.                              */
+}
+list_sort_list_writer_t;
+
+/*!
+ * @brief Write element to the next slot of normalized list.
+ *
+ * @return LIST_NO_ERR.
+ */
+static list_error_t list_sort_to_list
+(
+	void*       ctx,  /*!< [in,out] list_sort_list_writer_t.                 */
+	const void* elem  /*!< [in]     element.                                 */
+)
+{
+	list_sort_list_writer_t* writer = (list_sort_list_writer_t*) ctx;
+
+	memcpy((char*) writer->lst->data + writer->next * writer->lst->elem_size,
+	       elem, writer->lst->elem_size);
+	list_delta_touch(writer->lst, writer->next);
+	++writer->next;
+
+	return LIST_NO_ERR;
+}
+
+
+
+
+list_error_t list_sort_external (list_t lst,
+                                 int (*cmp) (const void*, const void*),
+                                 size_t budget, const char* tmp_dir)
+{
+	assert (lst);
+	assert (cmp);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	if (!budget)
+		budget = LIST_SORT_BUDGET;
+	if (!tmp_dir)
+		tmp_dir = "/tmp";
+
+	size_t elem_size = lst->elem_size;
+	size_t amount    = lst->size - 1;
+	if (amount < 2)
+		return LIST_NO_ERR;
+
+	list_normalize(lst);
+
+	// One arena of budget bytes holds a run while runs are cut and
+	// fan_in reader blocks plus one writer block while they are merged.
+	size_t run_size = (budget / elem_size > 3) ? budget / elem_size : 3;
+	size_t block    = (LIST_SORT_BLOCK / elem_size) ? LIST_SORT_BLOCK / elem_size
+	                                                : 1;
+	if (block > run_size / 3)
+		block = run_size / 3;
+	size_t fan_in      = run_size / block - 1;
+	size_t runs_amount = (amount + run_size - 1) / run_size;
+
+	// Single run is sorted in place without temporary file.
+	if (runs_amount == 1)
+	{
+		qsort((char*) lst->data + elem_size, amount, elem_size, cmp);
+		for (size_t i = 1; i <= amount; ++i)
+			list_delta_touch(lst, i);
+
+		return LIST_NO_ERR;
+	}
+
+	list_sort_merge_t merge;
+	merge.fd        = list_sort_open_tmp(tmp_dir);
+	merge.elem_size = elem_size;
+	merge.cmp       = cmp;
+	merge.readers   = (list_sort_reader_t*) calloc(fan_in,
+	                                             sizeof *merge.readers);
+	merge.heap      = (size_t*) calloc(fan_in, sizeof *merge.heap);
+	merge.amount    = 0;
+
+	list_sort_run_t* runs  = (list_sort_run_t*) calloc(runs_amount,
+	                                                   sizeof *runs);
+	char*            arena = (char*) malloc(run_size * elem_size);
+
+	list_error_t err = (merge.fd >= 0) ? LIST_NO_ERR : LIST_IO_ERR;
+	if (!merge.readers || !merge.heap || !runs || !arena)
+		err = LIST_ALLOC_ERR;
+
+	off_t offset = 0;
+	for (size_t r = 0; r < runs_amount && err == LIST_NO_ERR; ++r)
+	{
+		size_t first = r * run_size;
+		size_t size  = (amount - first < run_size) ? amount - first : run_size;
+
+		memcpy(arena, (char*) lst->data + (first + 1) * elem_size,
+		       size * elem_size);
+		qsort(arena, size, elem_size, cmp);
+
+		err = list_sort_write(merge.fd, arena, size * elem_size, offset);
+
+		runs[r].offset = offset;
+		runs[r].left   = size;
+		offset        += (off_t) (size * elem_size);
+	}
+
+	for (size_t i = 0; i < fan_in && err == LIST_NO_ERR; ++i)
+	{
+		merge.readers[i].buffer   = arena + i * block * elem_size;
+		merge.readers[i].capacity = block;
+	}
+
+	list_sort_writer_t writer;
+	writer.fd        = merge.fd;
+	writer.buffer    = arena + fan_in * block * elem_size;
+	writer.capacity  = block;
+	writer.elem_size = elem_size;
+	writer.offset    = offset;
+
+	while (runs_amount > fan_in && err == LIST_NO_ERR)
+	{
+		size_t merged = 0;
+		for (size_t r = 0; r < runs_amount && err == LIST_NO_ERR;
+		     r += fan_in, ++merged)
+		{
+			size_t group = (runs_amount - r < fan_in) ? runs_amount - r
+			                                          : fan_in;
+			size_t left  = 0;
+			for (size_t i = r; i < r + group; ++i)
+				left += runs[i].left;
+
+			list_sort_run_t result = { writer.offset, left };
+
+			writer.used = 0;
+			err = list_sort_merge(&merge, runs + r, group,
+			                      list_sort_to_file, &writer);
+			if (err == LIST_NO_ERR)
+				err = list_sort_flush(&writer);
+
+			runs[merged] = result;
+		}
+
+		runs_amount = merged;
+	}
+
+	if (err == LIST_NO_ERR)
+	{
+		list_sort_list_writer_t list_writer = { lst, 1 };
+		err = list_sort_merge(&merge, runs, runs_amount,
+		                      list_sort_to_list, &list_writer);
+	}
+
+	if (merge.fd >= 0)
+		close(merge.fd);
+	free(arena);
+	free(runs);
+	free(merge.heap);
+	free(merge.readers);
+
+	return err;
+}
@@ -0,0 +1,60 @@
+/*!
+ * @brief Header file with external sort of doubly linked lists.
+ */
+
+
+#ifndef LIST_SORT_H_
+#define LIST_SORT_H_
+
+#include "list.h"
+
+
+
+
+/*!
+ * @brief Default amount of memory used by list_sort_external().
+ */
+#define LIST_SORT_BUDGET ((size_t) 64 << 20)
+
+/*!
+ * @brief Size of the buffer of one sorted run during merging.
+ */
+#define LIST_SORT_BLOCK ((size_t) 1 << 16)
+
+
+
+
+/*!
+ * @brief Sort the list using temporary file and fixed amount of memory.
+ *
+ * The list is normalized, then its elements are streamed in the list
+ * order into sorted runs of budget bytes in temporary file. Runs are
+ * merged with k-way heap (in several passes if there are more runs than
+ * budget / LIST_SORT_BLOCK) and written back. Runs and merge buffers share
+ * one buffer of budget bytes. List which fits into budget is sorted
+ * in place without temporary file. Sorted list is normalized.
+ * The sort isn't stable.
+ *
+ * @note If I/O error occurs during the last merging, elements of the list
+ * are partially overwritten.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_sort_external
+(
+	list_t      lst,                              /*!< [in,out] list.        */
+	int       (*cmp) (const void*, const void*),  /*!< [in] function which
+	                                                   compares elements
+	                                                   like in qsort().      */
+	size_t      budget,                           /*!< [in] amount of memory
+	                                                   in bytes or 0 to use
+	                                                   LIST_SORT_BUDGET.     */
+	const char* tmp_dir                           /*!< [in] directory for
+	                                                   temporary file or
+	                                                   NULL to use /tmp.     */
+);
+
+
+
+
+#endif // undefined LIST_SORT_H_
@@ -0,0 +1,337 @@
+/*!
+ * @brief Header file with fixed capacity doubly linked list which can be
+ * built at compile time.
+ */
+
+
+#ifndef LIST_STATIC_HPP_
+#define LIST_STATIC_HPP_
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+
+
+namespace dll
+{
+
+/*!
+ * @brief Doubly linked list of at most N elements with the same layout
+ * as C list: data, nexts and prevs arrays with virtual element in slot 0
+ * and chain of free slots.
+ *
+ * All operations are constexpr, so constexpr list is built by compiler
+ * and placed in read-only memory. Elements must be default constructible
+ * literal types.
+ */
+template <typename T, std::size_t N>
+class static_list
+{
+	static_assert(std::is_default_constructible_v<T>,
+	              "free slots hold default constructed elements");
+
+	template <bool Const>
+	class basic_iterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type        = T;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = std::conditional_t<Const, const T*, T*>;
+		using reference         = std::conditional_t<Const, const T&, T&>;
+		using list_pointer      = std::conditional_t<Const, const static_list*,
+		                                                        static_list*>;
+
+		constexpr basic_iterator () noexcept = default;
+
+		constexpr basic_iterator (list_pointer lst, std::size_t it) noexcept
+			: lst_(lst), it_(it)
+		{}
+
+		template <bool OtherConst,
+		          typename = std::enable_if_t<Const && !OtherConst>>
+		constexpr basic_iterator (const basic_iterator<OtherConst>& other) noexcept
+			: lst_(other.lst_), it_(other.it_)
+		{}
+
+		constexpr reference operator* () const noexcept
+		{
+			return lst_->data_[it_];
+		}
+
+		constexpr pointer operator-> () const noexcept
+		{
+			return &lst_->data_[it_];
+		}
+
+		constexpr basic_iterator& operator++ () noexcept
+		{
+			it_ = lst_->nexts_[it_];
+			return *this;
+		}
+
+		constexpr basic_iterator operator++ (int) noexcept
+		{
+			basic_iterator old = *this;
+			++*this;
+			return old;
+		}
+
+		constexpr basic_iterator& operator-- () noexcept
+		{
+			it_ = lst_->prevs_[it_];
+			return *this;
+		}
+
+		constexpr basic_iterator operator-- (int) noexcept
+		{
+			basic_iterator old = *this;
+			--*this;
+			return old;
+		}
+
+		friend constexpr bool operator== (const basic_iterator& a,
+		                                  const basic_iterator& b) noexcept
+		{
+			return a.it_ == b.it_ && a.lst_ == b.lst_;
+		}
+
+		friend constexpr bool operator!= (const basic_iterator& a,
+		                                  const basic_iterator& b) noexcept
+		{
+			return !(a == b);
+		}
+
+		/*!
+		 * @brief Get index of slot.
+		 */
+		constexpr std::size_t index () const noexcept { return it_; }
+
+	private:
+		friend class static_list;
+		friend class basic_iterator<!Const>;
+
+		list_pointer lst_ = nullptr; /*!< list.                              */
+		std::size_t  it_  = 0;       /*!< index of element.                  */
+	};
+
+public:
+	using value_type      = T;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference       = T&;
+	using const_reference = const T&;
+	using iterator        = basic_iterator<false>;
+	using const_iterator  = basic_iterator<true>;
+	using reverse_iterator       = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	/*!
+	 * @brief Create empty list.
+	 */
+	constexpr static_list () noexcept
+	{
+		for (size_type i = 1; i <= N; ++i)
+		{
+			nexts_[i] = (i + 1) % (N + 1);
+			prevs_[i] = i;
+		}
+
+		first_free_ = (N) ? 1 : 0;
+	}
+
+	/*!
+	 * @brief Create list with elements in order of initializer list.
+	 */
+	constexpr static_list (std::initializer_list<T> values)
+		: static_list()
+	{
+		for (const T& value : values)
+			push_back(value);
+	}
+
+	constexpr size_type size     () const noexcept { return size_;     }
+	constexpr size_type capacity () const noexcept { return N;         }
+	constexpr bool      empty    () const noexcept { return !size_;    }
+	constexpr bool      full     () const noexcept { return size_ == N; }
+
+	/*!
+	 * @brief Is elements in slots 1..size() in the list order.
+	 */
+	constexpr bool is_normalized () const noexcept { return normalized_; }
+
+	constexpr iterator       begin  ()       noexcept { return { this, nexts_[0] }; }
+	constexpr const_iterator begin  () const noexcept { return { this, nexts_[0] }; }
+	constexpr const_iterator cbegin () const noexcept { return begin(); }
+	constexpr iterator       end    ()       noexcept { return { this, 0 }; }
+	constexpr const_iterator end    () const noexcept { return { this, 0 }; }
+	constexpr const_iterator cend   () const noexcept { return end(); }
+
+	constexpr reverse_iterator       rbegin ()       noexcept { return reverse_iterator(end());         }
+	constexpr const_reverse_iterator rbegin () const noexcept { return const_reverse_iterator(end());   }
+	constexpr reverse_iterator       rend   ()       noexcept { return reverse_iterator(begin());       }
+	constexpr const_reverse_iterator rend   () const noexcept { return const_reverse_iterator(begin()); }
+
+	constexpr reference       front ()       noexcept { return data_[nexts_[0]]; }
+	constexpr const_reference front () const noexcept { return data_[nexts_[0]]; }
+	constexpr reference       back  ()       noexcept { return data_[prevs_[0]]; }
+	constexpr const_reference back  () const noexcept { return data_[prevs_[0]]; }
+
+	/*!
+	 * @brief Get pointer to elements of normalized list.
+	 *
+	 * @return Pointer to the first element or nullptr if the list
+	 * isn't normalized.
+	 */
+	constexpr const T* data () const noexcept
+	{
+		return (normalized_) ? data_.data() + 1 : nullptr;
+	}
+
+	/*!
+	 * @brief Insert an element after the position.
+	 *
+	 * @return Iterator to new element.
+	 */
+	constexpr iterator insert_after (const_iterator pos, const T& value)
+	{
+		if (!first_free_)
+			throw std::length_error("static_list is full");
+
+		size_type it    = pos.it_;
+		size_type place = first_free_;
+		first_free_     = nexts_[place];
+
+		data_[place]          = value;
+		nexts_[place]         = nexts_[it];
+		prevs_[place]         = it;
+		nexts_[it]            = place;
+		prevs_[nexts_[place]] = place;
+
+		++size_;
+		if (nexts_[place] != 0 || place != size_)
+			normalized_ = false;
+
+		return { this, place };
+	}
+
+	/*!
+	 * @brief Insert an element before the position.
+	 *
+	 * @return Iterator to new element.
+	 */
+	constexpr iterator insert (const_iterator pos, const T& value)
+	{
+		return insert_after(const_iterator(this, prevs_[pos.it_]), value);
+	}
+
+	constexpr void push_back (const T& value)
+	{
+		insert_after(const_iterator(this, prevs_[0]), value);
+	}
+
+	constexpr void push_front (const T& value)
+	{
+		insert_after(cend(), value);
+	}
+
+	/*!
+	 * @brief Erase element.
+	 *
+	 * @return Iterator to the next element.
+	 */
+	constexpr iterator erase (const_iterator pos) noexcept
+	{
+		size_type it = pos.it_;
+		if (!it)
+			return end();
+
+		size_type next = nexts_[it];
+		size_type prev = prevs_[it];
+
+		nexts_[prev] = next;
+		prevs_[next] = prev;
+
+		if (next)
+			normalized_ = false;
+
+		data_[it]   = T();
+		nexts_[it]  = first_free_;
+		prevs_[it]  = it;
+		first_free_ = it;
+		--size_;
+
+		return { this, next };
+	}
+
+	constexpr void pop_back  () noexcept { erase(const_iterator(this, prevs_[0])); }
+	constexpr void pop_front () noexcept { erase(cbegin()); }
+
+	/*!
+	 * @brief Find the first element equal to value.
+	 *
+	 * @return Iterator to element or end() if it isn't found.
+	 */
+	constexpr const_iterator find (const T& value) const
+	{
+		for (const_iterator it = begin(); it != end(); ++it)
+			if (*it == value)
+				return it;
+
+		return end();
+	}
+
+	/*!
+	 * @brief Place elements in slots 1..size() in the list order.
+	 *
+	 * @note It invalidates iterators.
+	 */
+	constexpr void normalize ()
+	{
+		if (normalized_)
+			return;
+
+		std::array<T, N + 1> ordered = {};
+		size_type            i       = 1;
+		for (size_type it = nexts_[0]; it; it = nexts_[it])
+			ordered[i++] = std::move(data_[it]);
+
+		data_ = std::move(ordered);
+		for (i = 0; i <= N; ++i)
+		{
+			nexts_[i] = (i < size_) ? i + 1 : 0;
+			prevs_[i] = (i) ? i - 1 : size_;
+		}
+
+		for (i = size_ + 1; i <= N; ++i)
+		{
+			nexts_[i] = (i + 1) % (N + 1);
+			prevs_[i] = i;
+		}
+
+		first_free_ = (size_ < N) ? size_ + 1 : 0;
+		normalized_ = true;
+	}
+
+private:
+	std::array<T,         N + 1> data_  = {}; /*!< array with data.          */
+	std::array<size_type, N + 1> nexts_ = {}; /*!< indexes of next elements. */
+	std::array<size_type, N + 1> prevs_ = {}; /*!< indexes of previous
+	                                               elements.                 */
+	size_type first_free_ = 0;     /*!< index of first free element.         */
+	size_type size_       = 0;     /*!< amount of elements.                  */
+	bool      normalized_ = true;  /*!< is list normalized.                  */
+};
+
+} // namespace dll
+
+
+
+
+#endif // undefined LIST_STATIC_HPP_
@@ -0,0 +1,811 @@
+/*!
+ * @file Write-ahead log of doubly linked lists.
+ */
+
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <unistd.h>
+
+#include "list_io.h"
+#include "list_wal.h"
+
+
+
+
+/*!
+ * @brief Magic number of log.
+ */
+#define LIST_WAL_MAGIC "LSTW"
+
+/*!
+ * @brief Magic number of snapshot.
+ */
+#define LIST_WAL_SNAPSHOT_MAGIC "LSWS"
+
+/*!
+ * @brief Version of log and snapshot formats.
+ */
+#define LIST_WAL_VERSION ((uint32_t) 2)
+
+/*!
+ * @brief Maximal size of encoded number.
+ */
+#define LIST_WAL_NUMBER_MAX 10
+
+/*!
+ * @brief Size of checksum of log record.
+ */
+#define LIST_WAL_CHECKSUM_SIZE sizeof (uint32_t)
+
+/*!
+ * @brief Result of parsing log record which is torn by crash or garbage
+ * at the end of the log.
+ */
+#define LIST_WAL_TORN ((ssize_t) -1)
+
+/*!
+ * @brief Result of parsing log record which is intact but can't be
+ * performed onto the list.
+ */
+#define LIST_WAL_WRONG ((ssize_t) -2)
+
+/*!
+ * @brief Header of log and snapshot.
+ */
+typedef struct
+{
+	char     magic[4];   /*!< LIST_WAL_MAGIC or LIST_WAL_SNAPSHOT_MAGIC.     */
+	uint32_t version;    /*!< LIST_WAL_VERSION.                              */
+	uint64_t id;         /*!< identifier of checkpoint.                      */
+	uint64_t elem_size;  /*!< size of one element.                           */
+}
+list_wal_header_t;
+
+/*!
+ * @brief Types of log records.
+ */
+typedef enum
+{
+	LIST_WAL_INSERT_AFTER  = 1, /*!< iterator and value.                     */
+	LIST_WAL_INSERT_BEFORE = 2, /*!< iterator and value.                     */
+	LIST_WAL_SET           = 3, /*!< iterator and value.                     */
+	LIST_WAL_ERASE         = 4, /*!< iterator.                               */
+	LIST_WAL_CAPACITY      = 5, /*!< new capacity.                           */
+	LIST_WAL_NORMALIZE     = 6, /*!< nothing.                                */
+	LIST_WAL_CLEAR         = 7, /*!< nothing.                                */
+}
+list_wal_record_t;
+
+
+
+
+/*!
+ * @brief Write whole buffer to file descriptor.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_write
+(
+	int         fd,   /*!< [in] file descriptor.                             */
+	const void* buf,  /*!< [in] buffer.                                      */
+	size_t      size  /*!< [in] size of buffer.                              */
+)
+{
+	const char* ptr = (const char*) buf;
+	while (size)
+	{
+		ssize_t written = write(fd, ptr, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return LIST_IO_ERR;
+
+		ptr  += written;
+		size -= (size_t) written;
+	}
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Read buffer from file descriptor until its end.
+ *
+ * @return Amount of read bytes or -1 if some error has been occurred.
+ */
+static ssize_t list_wal_read
+(
+	int    fd,   /*!< [in]  file descriptor.                                 */
+	void*  buf,  /*!< [out] buffer.                                          */
+	size_t size  /*!< [in]  size of buffer.                                  */
+)
+{
+	char*  ptr  = (char*) buf;
+	size_t done = 0;
+	while (done < size)
+	{
+		ssize_t got = read(fd, ptr + done, size - done);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got < 0)
+			return -1;
+		if (got == 0)
+			break;
+
+		done += (size_t) got;
+	}
+
+	return (ssize_t) done;
+}
+
+/*!
+ * @brief Fill header of log or snapshot.
+ */
+static void list_wal_fill_header
+(
+	list_wal_header_t* header,    /*!< [out] header.                         */
+	const char*        magic,     /*!< [in]  magic number.                   */
+	uint64_t           id,        /*!< [in]  identifier of checkpoint.       */
+	size_t             elem_size  /*!< [in]  size of one element.            */
+)
+{
+	memset(header, 0, sizeof *header);
+	memcpy(header->magic, magic, sizeof header->magic);
+	header->version   = LIST_WAL_VERSION;
+	header->id        = id;
+	header->elem_size = elem_size;
+}
+
+/*!
+ * @brief Read and check header of log or snapshot.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_read_header
+(
+	int                fd,     /*!< [in]  file descriptor.                   */
+	const char*        magic,  /*!< [in]  expected magic number.             */
+	list_wal_header_t* header  /*!< [out] header.                            */
+)
+{
+	if (list_wal_read(fd, header, sizeof *header) != (ssize_t) sizeof *header
+	    || memcmp(header->magic, magic, sizeof header->magic)
+	    || header->version != LIST_WAL_VERSION
+	    || !header->elem_size)
+		return LIST_BAD_FORMAT;
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Fsync directory containing the file so that its renaming
+ * becomes durable.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_sync_dir
+(
+	const char* path /*!< [in] path to file.                                 */
+)
+{
+	const char* slash = strrchr(path, '/');
+	char*       dir   = (slash) ? strndup(path, (size_t) (slash - path) + 1)
+	                            : strdup(".");
+	if (!dir)
+		return LIST_ALLOC_ERR;
+
+	int fd = open(dir, O_RDONLY | O_DIRECTORY);
+	free(dir);
+	if (fd < 0)
+		return LIST_IO_ERR;
+
+	list_error_t err = (fsync(fd)) ? LIST_IO_ERR : LIST_NO_ERR;
+	close(fd);
+	return err;
+}
+
+/*!
+ * @brief Get time elapsed between two moments.
+ *
+ * @return Time in nanoseconds.
+ */
+static long list_wal_elapsed
+(
+	const struct timespec* from, /*!< [in] first moment.                     */
+	const struct timespec* to    /*!< [in] second moment.                    */
+)
+{
+	return (to->tv_sec - from->tv_sec) * 1000000000L
+	       + (to->tv_nsec - from->tv_nsec);
+}
+
+/*!
+ * @brief Write records gathered in the buffer.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_flush
+(
+	list_wal_t wal /*!< [in,out] log.                                        */
+)
+{
+	list_error_t err = list_wal_write(wal->fd, wal->buffer, wal->used);
+	wal->used = 0;
+	return err;
+}
+
+/*!
+ * @brief Encode number as varint.
+ *
+ * @return Amount of written bytes.
+ */
+static size_t list_wal_encode
+(
+	char*    buffer, /*!< [out] buffer of LIST_WAL_NUMBER_MAX bytes.        */
+	uint64_t number  /*!< [in]  number.                                     */
+)
+{
+	size_t len = 0;
+	while (number >= 0x80)
+	{
+		buffer[len++] = (char) (number | 0x80);
+		number >>= 7;
+	}
+	buffer[len++] = (char) number;
+
+	return len;
+}
+
+/*!
+ * @brief Decode varint.
+ *
+ * @return Amount of read bytes or 0 if number is incomplete.
+ */
+static size_t list_wal_decode
+(
+	const char* buffer, /*!< [in]  buffer.                                   */
+	size_t      size,   /*!< [in]  size of buffer.                           */
+	uint64_t*   number  /*!< [out] number.                                   */
+)
+{
+	*number = 0;
+	for (size_t len = 0; len < size && len < LIST_WAL_NUMBER_MAX; ++len)
+	{
+		*number |= (uint64_t) (buffer[len] & 0x7f) << (7 * len);
+		if (!(buffer[len] & 0x80))
+			return len + 1;
+	}
+
+	return 0;
+}
+
+/*!
+ * @brief Compute FNV-1a checksum of log record.
+ *
+ * @return Checksum.
+ */
+static uint32_t list_wal_checksum
+(
+	const char* buffer, /*!< [in] record.                                    */
+	size_t      size    /*!< [in] size of record.                            */
+)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= (unsigned char) buffer[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/*!
+ * @brief Append record to the log and commit group of records
+ * if it is needed.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_append
+(
+	list_wal_t        wal,    /*!< [in,out] log.                             */
+	list_wal_record_t type,   /*!< [in]     type of record.                  */
+	uint64_t          arg,    /*!< [in]     iterator or capacity.            */
+	const void*       value   /*!< [in]     value or NULL.                   */
+)
+{
+	char   arg_buffer[LIST_WAL_NUMBER_MAX];
+	size_t arg_len    = (type <= LIST_WAL_CAPACITY)
+	                    ? list_wal_encode(arg_buffer, arg) : 0;
+	size_t value_size = (value) ? wal->lst->elem_size : 0;
+	size_t body_size  = 1 + arg_len + value_size;
+
+	list_error_t err = LIST_NO_ERR;
+	if (wal->used + LIST_WAL_NUMBER_MAX + body_size + LIST_WAL_CHECKSUM_SIZE
+	    > wal->buffer_size)
+		err = list_wal_flush(wal);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	// Record: size of body, body (type, argument, value) and its checksum.
+	char* ptr  = wal->buffer + wal->used;
+	ptr       += list_wal_encode(ptr, body_size);
+	char* body = ptr;
+
+	*ptr++ = (char) type;
+	memcpy(ptr, arg_buffer, arg_len);
+	ptr += arg_len;
+	if (value)
+		memcpy(ptr, value, value_size);
+	ptr += value_size;
+
+	uint32_t checksum = list_wal_checksum(body, body_size);
+	memcpy(ptr, &checksum, LIST_WAL_CHECKSUM_SIZE);
+	ptr += LIST_WAL_CHECKSUM_SIZE;
+
+	wal->used = (size_t) (ptr - wal->buffer);
+
+	if (++wal->pending >= wal->batch)
+		return list_wal_commit(wal);
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (list_wal_elapsed(&wal->last_commit, &now) >= wal->interval)
+		return list_wal_commit(wal);
+
+	return LIST_NO_ERR;
+}
+
+/*!
+ * @brief Perform one record onto the list.
+ *
+ * @return Amount of read bytes, 0 if record is incomplete, LIST_WAL_TORN
+ * if record is broken (its size or checksum is wrong) or LIST_WAL_WRONG
+ * if intact record can't be performed.
+ */
+static ssize_t list_wal_perform
+(
+	list_t      lst,    /*!< [in,out] list.                                  */
+	const char* buffer, /*!< [in]     buffer.                                */
+	size_t      size    /*!< [in]     size of buffer.                        */
+)
+{
+	uint64_t body_size = 0;
+	size_t   size_len  = list_wal_decode(buffer, size, &body_size);
+	if (!size_len)
+		return (size < LIST_WAL_NUMBER_MAX) ? 0 : LIST_WAL_TORN;
+
+	if (!body_size || body_size > 1 + LIST_WAL_NUMBER_MAX + lst->elem_size)
+		return LIST_WAL_TORN;
+
+	size_t record_size = size_len + (size_t) body_size + LIST_WAL_CHECKSUM_SIZE;
+	if (size < record_size)
+		return 0;
+
+	const char* body = buffer + size_len;
+	uint32_t    checksum;
+	memcpy(&checksum, body + body_size, LIST_WAL_CHECKSUM_SIZE);
+	if (checksum != list_wal_checksum(body, (size_t) body_size))
+		return LIST_WAL_TORN;
+
+	list_wal_record_t type = (list_wal_record_t) body[0];
+	size_t            len  = 1;
+	uint64_t          arg  = 0;
+
+	if (type < LIST_WAL_INSERT_AFTER || type > LIST_WAL_CLEAR)
+		return LIST_WAL_WRONG;
+
+	if (type <= LIST_WAL_CAPACITY)
+	{
+		size_t arg_len = list_wal_decode(body + len, (size_t) body_size - len,
+		                                 &arg);
+		if (!arg_len)
+			return LIST_WAL_WRONG;
+		len += arg_len;
+	}
+
+	const char* value = body + len;
+	if (type <= LIST_WAL_SET)
+		len += lst->elem_size;
+
+	if (len != body_size)
+		return LIST_WAL_WRONG;
+
+	list_iterator_t it  = (list_iterator_t) arg;
+	list_error_t    err = LIST_NO_ERR;
+	switch (type)
+	{
+		case LIST_WAL_INSERT_AFTER:
+			err = list_insert_after(lst, it, value);
+			break;
+
+		case LIST_WAL_INSERT_BEFORE:
+			err = list_insert_before(lst, it, value);
+			break;
+
+		case LIST_WAL_SET:
+			if (!it || !list_check_iterator(lst, it))
+				err = LIST_BAD_ITERATOR;
+			else
+			{
+				memcpy((char*) lst->data + it * lst->elem_size, value,
+				       lst->elem_size);
+				list_delta_touch(lst, it);
+			}
+			break;
+
+		case LIST_WAL_ERASE:
+			err = list_erase(lst, &it);
+			break;
+
+		case LIST_WAL_CAPACITY:
+			err = list_change_capacity(lst, (size_t) arg);
+			break;
+
+		case LIST_WAL_NORMALIZE:
+			list_normalize(lst);
+			break;
+
+		case LIST_WAL_CLEAR:
+			err = list_clear(lst);
+			break;
+
+		default:
+			return LIST_WAL_WRONG;
+	}
+
+	return (err == LIST_NO_ERR) ? (ssize_t) record_size : LIST_WAL_WRONG;
+}
+
+/*!
+ * @brief Replay records of the log onto the list.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_replay
+(
+	list_t lst, /*!< [in,out] list.                                          */
+	int    fd   /*!< [in]     file descriptor positioned after header.       */
+)
+{
+	size_t buffer_size = LIST_WAL_BUFFER + 2 * LIST_WAL_NUMBER_MAX + 1
+	                     + lst->elem_size + LIST_WAL_CHECKSUM_SIZE;
+	char*  buffer      = (char*) malloc(buffer_size);
+	if (!buffer)
+		return LIST_ALLOC_ERR;
+
+	list_error_t err  = LIST_NO_ERR;
+	size_t       used = 0;
+	bool         torn = false;
+	for (;;)
+	{
+		ssize_t got = list_wal_read(fd, buffer + used, buffer_size - used);
+		if (got < 0)
+		{
+			err = LIST_IO_ERR;
+			break;
+		}
+		used += (size_t) got;
+
+		size_t done = 0;
+		while (done < used)
+		{
+			ssize_t len = list_wal_perform(lst, buffer + done, used - done);
+			// Broken record is the end of the log written before crash.
+			if (len == LIST_WAL_TORN)
+				torn = true;
+			if (len == LIST_WAL_WRONG)
+				err = LIST_BAD_FORMAT;
+			if (len <= 0)
+				break;
+
+			done += (size_t) len;
+		}
+
+		memmove(buffer, buffer + done, used - done);
+		used -= done;
+
+		if (err != LIST_NO_ERR || torn || got == 0)
+			break;
+	}
+
+	free(buffer);
+	return err;
+}
+
+/*!
+ * @brief Write snapshot of the list with the header to temporary file
+ * and replace the snapshot by it.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+static list_error_t list_wal_write_snapshot
+(
+	list_wal_t wal /*!< [in] log.                                            */
+)
+{
+	size_t path_len = strlen(wal->snapshot_path);
+	char*  tmp_path = (char*) malloc(path_len + sizeof ".tmp");
+	if (!tmp_path)
+		return LIST_ALLOC_ERR;
+	memcpy(tmp_path, wal->snapshot_path, path_len);
+	memcpy(tmp_path + path_len, ".tmp", sizeof ".tmp");
+
+	int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		free(tmp_path);
+		return LIST_IO_ERR;
+	}
+
+	list_wal_header_t header;
+	list_wal_fill_header(&header, LIST_WAL_SNAPSHOT_MAGIC, wal->id,
+	                     wal->lst->elem_size);
+
+	list_error_t err = list_wal_write(fd, &header, sizeof header);
+	if (err == LIST_NO_ERR)
+		err = list_save(wal->lst, fd, LIST_SAVE_COMPRESSED);
+	if (err == LIST_NO_ERR && fsync(fd))
+		err = LIST_IO_ERR;
+	if (close(fd) && err == LIST_NO_ERR)
+		err = LIST_IO_ERR;
+
+	if (err == LIST_NO_ERR && rename(tmp_path, wal->snapshot_path))
+		err = LIST_IO_ERR;
+	if (err == LIST_NO_ERR)
+		err = list_wal_sync_dir(wal->snapshot_path);
+
+	free(tmp_path);
+	return err;
+}
+
+
+
+
+list_wal_t list_wal_open (list_t lst, const char* snapshot_path,
+                          const char* log_path, size_t batch, long interval)
+{
+	assert (lst);
+	assert (snapshot_path);
+	assert (log_path);
+	assert (list_verify(lst) == LIST_NO_ERR);
+
+	list_wal_t wal = (list_wal_t) calloc(1, sizeof *wal);
+	if (!wal)
+		return NULL;
+
+	wal->lst           = lst;
+	wal->batch         = (batch) ? batch : 1;
+	wal->interval      = interval;
+	wal->buffer_size   = LIST_WAL_BUFFER + 1 + LIST_WAL_NUMBER_MAX
+	                     + lst->elem_size;
+	wal->buffer        = (char*) malloc(wal->buffer_size);
+	wal->snapshot_path = strdup(snapshot_path);
+	wal->fd            = open(log_path, O_WRONLY | O_CREAT, 0644);
+
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	wal->id = (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+
+	if (!wal->buffer || !wal->snapshot_path || wal->fd < 0
+	    || list_wal_checkpoint(wal) != LIST_NO_ERR)
+	{
+		if (wal->fd >= 0)
+			close(wal->fd);
+		free(wal->buffer);
+		free(wal->snapshot_path);
+		free(wal);
+		return NULL;
+	}
+
+	return wal;
+}
+
+
+list_wal_t list_wal_close (list_wal_t wal)
+{
+	if (wal)
+	{
+		list_wal_commit(wal);
+		close(wal->fd);
+		free(wal->buffer);
+		free(wal->snapshot_path);
+		free(wal);
+	}
+
+	return NULL;
+}
+
+
+list_error_t list_wal_commit (list_wal_t wal)
+{
+	assert (wal);
+
+	list_error_t err = list_wal_flush(wal);
+	if (err == LIST_NO_ERR && fdatasync(wal->fd))
+		err = LIST_IO_ERR;
+
+	wal->pending = 0;
+	clock_gettime(CLOCK_MONOTONIC, &wal->last_commit);
+	return err;
+}
+
+
+list_error_t list_wal_checkpoint (list_wal_t wal)
+{
+	assert (wal);
+
+	list_error_t err = list_wal_commit(wal);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	++wal->id;
+	err = list_wal_write_snapshot(wal);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	list_wal_header_t header;
+	list_wal_fill_header(&header, LIST_WAL_MAGIC, wal->id,
+	                     wal->lst->elem_size);
+
+	if (ftruncate(wal->fd, 0) || lseek(wal->fd, 0, SEEK_SET))
+		return LIST_IO_ERR;
+
+	err = list_wal_write(wal->fd, &header, sizeof header);
+	if (err == LIST_NO_ERR && fsync(wal->fd))
+		err = LIST_IO_ERR;
+
+	return err;
+}
+
+
+list_error_t list_wal_insert_after (list_wal_t wal, const list_iterator_t it,
+                                    const void* value)
+{
+	assert (wal);
+
+	list_error_t err = list_insert_after(wal->lst, it, value);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	return list_wal_append(wal, LIST_WAL_INSERT_AFTER, it, value);
+}
+
+
+list_error_t list_wal_insert_before (list_wal_t wal, const list_iterator_t it,
+                                     const void* value)
+{
+	assert (wal);
+
+	list_error_t err = list_insert_before(wal->lst, it, value);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	return list_wal_append(wal, LIST_WAL_INSERT_BEFORE, it, value);
+}
+
+
+list_error_t list_wal_insert_to_head (list_wal_t wal, const void* value)
+{
+	assert (wal);
+
+	return list_wal_insert_before(wal, wal->lst->head, value);
+}
+
+
+list_error_t list_wal_insert_to_tail (list_wal_t wal, const void* value)
+{
+	assert (wal);
+
+	return list_wal_insert_after(wal, wal->lst->tail, value);
+}
+
+
+list_error_t list_wal_set (list_wal_t wal, const list_iterator_t it,
+                           const void* value)
+{
+	assert (wal);
+	assert (value);
+
+	void* elem = list_get(wal->lst, it);
+	if (!it || !elem)
+		return LIST_BAD_ITERATOR;
+
+	memcpy(elem, value, wal->lst->elem_size);
+	list_delta_touch(wal->lst, it);
+
+	return list_wal_append(wal, LIST_WAL_SET, it, value);
+}
+
+
+list_error_t list_wal_erase (list_wal_t wal, list_iterator_t* it)
+{
+	assert (wal);
+	assert (it);
+
+	list_iterator_t erased = *it;
+	list_error_t    err    = list_erase(wal->lst, it);
+	if (err != LIST_NO_ERR || !erased)
+		return err;
+
+	return list_wal_append(wal, LIST_WAL_ERASE, erased, NULL);
+}
+
+
+list_error_t list_wal_change_capacity (list_wal_t wal, size_t new_capacity)
+{
+	assert (wal);
+
+	list_error_t err = list_change_capacity(wal->lst, new_capacity);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	return list_wal_append(wal, LIST_WAL_CAPACITY, new_capacity, NULL);
+}
+
+
+list_error_t list_wal_normalize (list_wal_t wal)
+{
+	assert (wal);
+
+	list_normalize(wal->lst);
+	return list_wal_append(wal, LIST_WAL_NORMALIZE, 0, NULL);
+}
+
+
+list_error_t list_wal_clear (list_wal_t wal)
+{
+	assert (wal);
+
+	list_error_t err = list_clear(wal->lst);
+	if (err != LIST_NO_ERR)
+		return err;
+
+	return list_wal_append(wal, LIST_WAL_CLEAR, 0, NULL);
+}
+
+
+list_t list_wal_recover (const char* snapshot_path, const char* log_path,
+                         void (*print_func) (const void*, FILE*))
+{
+	assert (snapshot_path);
+	assert (log_path);
+
+	int snapshot_fd = open(snapshot_path, O_RDONLY);
+	if (snapshot_fd < 0)
+		return NULL;
+
+	list_wal_header_t snapshot_header;
+	list_t            lst = NULL;
+	if (list_wal_read_header(snapshot_fd, LIST_WAL_SNAPSHOT_MAGIC,
+	                         &snapshot_header) == LIST_NO_ERR)
+		lst = list_load(snapshot_fd, print_func);
+	close(snapshot_fd);
+
+	if (!lst || lst->elem_size != snapshot_header.elem_size)
+		return list_destroy(lst);
+
+	int log_fd = open(log_path, O_RDONLY);
+	if (log_fd < 0)
+		return lst;
+
+	// Log of older checkpoint is already included into the snapshot.
+	// Log without header remains if crash has happened during checkpoint.
+	list_wal_header_t log_header;
+	list_error_t      err = LIST_NO_ERR;
+	if (list_wal_read_header(log_fd, LIST_WAL_MAGIC, &log_header)
+	    == LIST_NO_ERR
+	    && log_header.id == snapshot_header.id
+	    && log_header.elem_size == lst->elem_size)
+		err = list_wal_replay(lst, log_fd);
+	close(log_fd);
+
+	if (err != LIST_NO_ERR)
+		return list_destroy(lst);
+
+	return lst;
+}
@@ -0,0 +1,229 @@
+/*!
+ * @brief Header file with write-ahead log of doubly linked lists.
+ */
+
+
+#ifndef LIST_WAL_H_
+#define LIST_WAL_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include "list.h"
+
+
+
+
+/*!
+ * @brief Size of the buffer where records are gathered before writing.
+ */
+#define LIST_WAL_BUFFER ((size_t) 1 << 16)
+
+
+
+
+/*!
+ * @brief Write-ahead log of list mutations.
+ */
+typedef struct list_wal_t_
+{
+	list_t          lst;           /*!< logged list.                         */
+	int             fd;            /*!< descriptor of log file.              */
+	char*           snapshot_path; /*!< path to snapshot.                    */
+	uint64_t        id;            /*!< identifier of the last checkpoint.   */
+	char*           buffer;        /*!< records which aren't written yet.    */
+	size_t          buffer_size;   /*!< size of buffer.                      */
+	size_t          used;          /*!< used bytes of buffer.                */
+	size_t          batch;         /*!< amount of records per fsync.         */
+	size_t          pending;       /*!< amount of records since last fsync.  */
+	long            interval;      /*!< maximal time between fsyncs
+	                                    in nanoseconds.                      */
+	struct timespec last_commit;   /*!< time of last fsync.                  */
+}
+*list_wal_t;
+
+
+
+
+/*!
+ * @brief Start logging of the list.
+ *
+ * It makes a checkpoint of the list: the snapshot is replaced and the log
+ * is truncated. The log contains records of mutations performed after
+ * the checkpoint. Records are made durable by group commit: one fsync
+ * per batch records or per interval, whichever comes first (interval is
+ * checked when mutation is logged), and by list_wal_commit(). Mutations
+ * after the last commit can be lost by crash.
+ *
+ * @note List must be changed only by list_wal_* functions while
+ * it is logged. Don't forget to stop logging using list_wal_close().
+ *
+ * @return Created log. If some error has been occurred it returns NULL.
+ */
+list_wal_t list_wal_open
+(
+	list_t      lst,           /*!< [in] logged list.                        */
+	const char* snapshot_path, /*!< [in] path to snapshot.                   */
+	const char* log_path,      /*!< [in] path to log.                        */
+	size_t      batch,         /*!< [in] amount of records per fsync.        */
+	long        interval       /*!< [in] maximal time between fsyncs
+	                                     in nanoseconds.                     */
+);
+
+/*!
+ * @brief Commit all records and stop logging. List isn't destroyed.
+ *
+ * @return NULL.
+ */
+list_wal_t list_wal_close
+(
+	list_wal_t wal /*!< [in] log.                                            */
+);
+
+/*!
+ * @brief Write and fsync all records.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_commit
+(
+	list_wal_t wal /*!< [in,out] log.                                        */
+);
+
+/*!
+ * @brief Save the list to the snapshot and truncate the log.
+ *
+ * Snapshot is written to a temporary file which replaces the old one.
+ * Snapshot and log are marked by identifier of checkpoint, so the log
+ * isn't replayed onto newer snapshot if crash happens before truncation.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_checkpoint
+(
+	list_wal_t wal /*!< [in,out] log.                                        */
+);
+
+/*!
+ * @brief Log and perform list_insert_after().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_insert_after
+(
+	list_wal_t            wal,   /*!< [in,out] log.                          */
+	const list_iterator_t it,    /*!< [in]     an iterator.                  */
+	const void*           value  /*!< [in]     inserting value.              */
+);
+
+/*!
+ * @brief Log and perform list_insert_before().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_insert_before
+(
+	list_wal_t            wal,   /*!< [in,out] log.                          */
+	const list_iterator_t it,    /*!< [in]     an iterator.                  */
+	const void*           value  /*!< [in]     inserting value.              */
+);
+
+/*!
+ * @brief Log and perform list_insert_to_head().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_insert_to_head
+(
+	list_wal_t  wal,   /*!< [in,out] log.                                    */
+	const void* value  /*!< [in]     inserting value.                        */
+);
+
+/*!
+ * @brief Log and perform list_insert_to_tail().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_insert_to_tail
+(
+	list_wal_t  wal,   /*!< [in,out] log.                                    */
+	const void* value  /*!< [in]     inserting value.                        */
+);
+
+/*!
+ * @brief Log and change value of element.
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_set
+(
+	list_wal_t            wal,   /*!< [in,out] log.                          */
+	const list_iterator_t it,    /*!< [in]     an iterator.                  */
+	const void*           value  /*!< [in]     new value.                    */
+);
+
+/*!
+ * @brief Log and perform list_erase().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_erase
+(
+	list_wal_t       wal, /*!< [in,out] log.                                 */
+	list_iterator_t* it   /*!< [in,out] an iterator.                         */
+);
+
+/*!
+ * @brief Log and perform list_change_capacity().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_change_capacity
+(
+	list_wal_t wal,         /*!< [in,out] log.                               */
+	size_t     new_capacity /*!< [in]     new capacity.                      */
+);
+
+/*!
+ * @brief Log and perform list_normalize().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_normalize
+(
+	list_wal_t wal /*!< [in,out] log.                                        */
+);
+
+/*!
+ * @brief Log and perform list_clear().
+ *
+ * @return Error code which has been occurred during performing this function.
+ */
+list_error_t list_wal_clear
+(
+	list_wal_t wal /*!< [in,out] log.                                        */
+);
+
+/*!
+ * @brief Load the snapshot and replay the log onto it.
+ *
+ * Every record has its size and checksum. Replay stops at the first
+ * broken record (torn by crash, zeros or garbage at the end of the log)
+ * and the list is recovered to the last intact record.
+ *
+ * @note Don't forget to free memory using list_destroy() function.
+ *
+ * @return Recovered list or NULL if some error has been occurred.
+ */
+list_t list_wal_recover
+(
+	const char* snapshot_path,              /*!< [in] path to snapshot.      */
+	const char* log_path,                   /*!< [in] path to log.           */
+	void (*print_func) (const void*, FILE*) /*!< [in] function which prints
+	                                                  one list element.      */
+);
+
+
+
+
+#endif // undefined LIST_WAL_H_